@@ -0,0 +1,98 @@
+// CL_Yahtzee batch scoring
+
+#include "batch_score.h"
+#include "batch_score_kernel.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BATCH_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+// batch_score_avx2.cpp
+size_t score_batch_avx2(const uint8_t* const dice[NUM_DICE], size_t count, uint8_t* const scores[NUM_CATEGORIES]);
+bool batch_avx2_built();
+
+namespace {
+
+#ifdef BATCH_HAVE_SSE2
+struct Sse2 {
+    typedef __m128i reg;
+    static const size_t WIDTH = 16;
+    static reg load(const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(uint8_t* p, reg v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static reg set1(uint8_t v) { return _mm_set1_epi8(char(v)); }
+    static reg add(reg a, reg b) { return _mm_add_epi8(a, b); }
+    static reg sub(reg a, reg b) { return _mm_sub_epi8(a, b); }
+    static reg and_(reg a, reg b) { return _mm_and_si128(a, b); }
+    static reg or_(reg a, reg b) { return _mm_or_si128(a, b); }
+    static reg cmpeq(reg a, reg b) { return _mm_cmpeq_epi8(a, b); }
+    static reg cmpgt(reg a, reg b) { return _mm_cmpgt_epi8(a, b); }
+    static reg max(reg a, reg b) { return _mm_max_epu8(a, b); }
+};
+#endif
+
+// one table row per hand: the scalar path and the tail of every vector batch
+void score_batch_scalar(const uint8_t* const dice[NUM_DICE], size_t begin, size_t count,
+                        uint8_t* const scores[NUM_CATEGORIES]) {
+    for (size_t n = begin; n < count; ++n) {
+        const uint8_t hand[NUM_DICE] = { dice[0][n], dice[1][n], dice[2][n], dice[3][n], dice[4][n] };
+        const uint8_t* row = hand_scores(hand_index(hand));
+        for (int c = 0; c < NUM_CATEGORIES; ++c) scores[c][n] = row[c];
+    }
+}
+
+bool cpu_has_avx2() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 1);
+    const bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;   // OSXSAVE, XMM+YMM state
+    __cpuidex(info, 7, 0);
+    return os_saves_ymm && (info[1] & (1 << 5));
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+BatchIsa batch_isa() {
+    static const BatchIsa isa = batch_avx2_built() && cpu_has_avx2() ? BATCH_AVX2
+#ifdef BATCH_HAVE_SSE2
+                                                                     : BATCH_SSE2;
+#else
+                                                                     : BATCH_SCALAR;
+#endif
+    return isa;
+}
+
+const char* batch_isa_name(BatchIsa isa) {
+    switch (isa) {
+        case BATCH_AVX2: return "avx2";
+        case BATCH_SSE2: return "sse2";
+        default:         return "scalar";
+    }
+}
+
+void score_batch(BatchIsa isa, const uint8_t* const dice[NUM_DICE], size_t count,
+                 uint8_t* const scores[NUM_CATEGORIES]) {
+    size_t done = 0;
+    if (isa == BATCH_AVX2 && batch_isa() == BATCH_AVX2) {
+        done = score_batch_avx2(dice, count, scores);
+    }
+#ifdef BATCH_HAVE_SSE2
+    else if (isa != BATCH_SCALAR) {
+        done = score_batch_kernel<Sse2>(dice, count, scores);
+    }
+#endif
+    score_batch_scalar(dice, done, count, scores);
+}
+
+void score_batch(const uint8_t* const dice[NUM_DICE], size_t count, uint8_t* const scores[NUM_CATEGORIES]) {
+    score_batch(batch_isa(), dice, count, scores);
+}
@@ -0,0 +1,24 @@
+// CL_Yahtzee batch scoring
+// Scores large blocks of hands at once with SIMD (AVX2 or SSE2, picked at
+// runtime) for offline analysis. Hands are given structure-of-arrays style.
+
+#pragma once
+
+#include "yahtzee.h"
+
+#include <cstddef>
+
+enum BatchIsa { BATCH_SCALAR, BATCH_SSE2, BATCH_AVX2 };
+
+// Best kernel the CPU running us supports.
+BatchIsa batch_isa();
+const char* batch_isa_name(BatchIsa isa);
+
+// dice[i][n] is die i of hand n (faces 1..6); writes scores[c][n], the points
+// hand n scores in category c, for n in [0, count).
+void score_batch(const uint8_t* const dice[NUM_DICE], size_t count, uint8_t* const scores[NUM_CATEGORIES]);
+
+// Same with an explicit kernel (for benchmarks); falls back to scalar if the
+// CPU or build lacks it.
+void score_batch(BatchIsa isa, const uint8_t* const dice[NUM_DICE], size_t count,
+                 uint8_t* const scores[NUM_CATEGORIES]);
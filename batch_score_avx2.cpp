@@ -0,0 +1,36 @@
+// CL_Yahtzee batch scoring: AVX2 kernel (this file alone is built with AVX2 enabled)
+
+#include "batch_score_kernel.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace {
+
+struct Avx2 {
+    typedef __m256i reg;
+    static const size_t WIDTH = 32;
+    static reg load(const uint8_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(uint8_t* p, reg v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static reg set1(uint8_t v) { return _mm256_set1_epi8(char(v)); }
+    static reg add(reg a, reg b) { return _mm256_add_epi8(a, b); }
+    static reg sub(reg a, reg b) { return _mm256_sub_epi8(a, b); }
+    static reg and_(reg a, reg b) { return _mm256_and_si256(a, b); }
+    static reg or_(reg a, reg b) { return _mm256_or_si256(a, b); }
+    static reg cmpeq(reg a, reg b) { return _mm256_cmpeq_epi8(a, b); }
+    static reg cmpgt(reg a, reg b) { return _mm256_cmpgt_epi8(a, b); }
+    static reg max(reg a, reg b) { return _mm256_max_epu8(a, b); }
+};
+
+} // namespace
+
+size_t score_batch_avx2(const uint8_t* const dice[NUM_DICE], size_t count, uint8_t* const scores[NUM_CATEGORIES]) {
+    return score_batch_kernel<Avx2>(dice, count, scores);
+}
+
+bool batch_avx2_built() { return true; }
+#else
+size_t score_batch_avx2(const uint8_t* const[NUM_DICE], size_t, uint8_t* const[NUM_CATEGORIES]) { return 0; }
+
+bool batch_avx2_built() { return false; }
+#endif
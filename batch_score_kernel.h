@@ -0,0 +1,71 @@
+// CL_Yahtzee batch scoring: vector kernel shared by the SSE2 and AVX2 builds.
+// V wraps one instruction set: a register of V::WIDTH unsigned bytes.
+
+#pragma once
+
+#include "yahtzee.h"
+
+#include <cstddef>
+
+template <class V>
+size_t score_batch_kernel(const uint8_t* const dice[NUM_DICE], size_t count,
+                          uint8_t* const scores[NUM_CATEGORIES]) {
+    typedef typename V::reg reg;
+    const reg zero = V::set1(0);
+    size_t n = 0;
+    for (; n + V::WIDTH <= count; n += V::WIDTH) {
+        reg d[NUM_DICE];
+        for (int i = 0; i < NUM_DICE; ++i) d[i] = V::load(dice[i] + n);
+        reg sum = V::add(V::add(V::add(d[0], d[1]), V::add(d[2], d[3])), d[4]);
+
+        // per-face counts: each equal die adds 0xff, so subtract
+        reg count_of[7];
+        reg max_count = zero, any2 = zero, any3 = zero;
+        for (int f = 1; f <= 6; ++f) {
+            const reg face = V::set1(uint8_t(f));
+            reg c = zero;
+            for (int i = 0; i < NUM_DICE; ++i) c = V::sub(c, V::cmpeq(d[i], face));
+            count_of[f] = c;
+            max_count = V::max(max_count, c);
+            any2 = V::or_(any2, V::cmpeq(c, V::set1(2)));
+            any3 = V::or_(any3, V::cmpeq(c, V::set1(3)));
+        }
+
+        // upper section: count * face by doubling and adding
+        const reg c1 = count_of[1];
+        const reg c2 = V::add(count_of[2], count_of[2]);
+        const reg c3 = V::add(V::add(count_of[3], count_of[3]), count_of[3]);
+        const reg c4x2 = V::add(count_of[4], count_of[4]);
+        const reg c4 = V::add(c4x2, c4x2);
+        const reg c5x2 = V::add(count_of[5], count_of[5]);
+        const reg c5 = V::add(V::add(c5x2, c5x2), count_of[5]);
+        const reg c6x3 = V::add(V::add(count_of[6], count_of[6]), count_of[6]);
+        const reg c6 = V::add(c6x3, c6x3);
+        V::store(scores[ONES] + n, c1);
+        V::store(scores[TWOS] + n, c2);
+        V::store(scores[THREES] + n, c3);
+        V::store(scores[FOURS] + n, c4);
+        V::store(scores[FIVES] + n, c5);
+        V::store(scores[SIXES] + n, c6);
+
+        const reg has3 = V::cmpgt(max_count, V::set1(2));
+        const reg has4 = V::cmpgt(max_count, V::set1(3));
+        const reg has5 = V::cmpeq(max_count, V::set1(5));
+        reg present[7];
+        for (int f = 1; f <= 6; ++f) present[f] = V::cmpgt(count_of[f], zero);
+        const reg run2to5 = V::and_(V::and_(present[2], present[3]), V::and_(present[4], present[5]));
+        const reg run3to4 = V::and_(present[3], present[4]);
+        const reg small = V::or_(V::or_(V::and_(V::and_(present[1], present[2]), run3to4), run2to5),
+                                 V::and_(V::and_(present[5], present[6]), run3to4));
+        const reg large = V::or_(V::and_(run2to5, present[1]), V::and_(run2to5, present[6]));
+
+        V::store(scores[THREE_OF_A_KIND] + n, V::and_(has3, sum));
+        V::store(scores[FOUR_OF_A_KIND] + n, V::and_(has4, sum));
+        V::store(scores[FULL_HOUSE] + n, V::and_(V::and_(any2, any3), V::set1(25)));
+        V::store(scores[SML_STRAIGHT] + n, V::and_(small, V::set1(30)));
+        V::store(scores[LRG_STRAIGHT] + n, V::and_(large, V::set1(40)));
+        V::store(scores[YAHTZEE] + n, V::and_(has5, V::set1(50)));
+        V::store(scores[CHANCE] + n, sum);
+    }
+    return n; // hands past this are left to the scalar tail
+}
@@ -0,0 +1,384 @@
+// CL_Yahtzee micro-benchmarks
+// Times the hot paths (scoring, dice, rendering, playouts, solver) and reports
+// ns per operation as min/median/p99 over repeated samples.
+//
+//   bench [--filter text] [--samples N] [--json file] [--solver-table file]
+//         [--distribution-table file]
+
+#include "yahtzee.h"
+#include "batch_score.h"
+#include "checkpoint.h"
+#include "distribution.h"
+#include "reroll.h"
+#include "draw.h"
+#include "screen.h"
+#include "simulate.h"
+#include "solver.h"
+#include "strategy.h"
+#include "variant.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Result {
+    std::string name;
+    uint64_t ops = 0;               // operations per sample
+    double min = 0, median = 0, p99 = 0;  // ns per operation
+};
+
+// results are folded into this so the timed work can't be optimized away
+volatile uint64_t sink;
+
+int samples = 101;
+const char* filter = nullptr;
+std::vector<Result> results;
+
+// Runs op(i) for i = 0, 1, ... in samples of `ops` calls, after sizing ops so a
+// sample takes about a millisecond.
+template <class Op>
+void bench(const char* name, Op op) {
+    if (filter && !std::strstr(name, filter)) return;
+    typedef std::chrono::steady_clock clock;
+    uint64_t ops = 1, i = 0, acc = 0;
+    for (;;) {
+        auto t0 = clock::now();
+        for (uint64_t k = 0; k < ops; ++k) acc += op(i++);
+        if (clock::now() - t0 > std::chrono::microseconds(200) || ops >= (1u << 24)) break;
+        ops *= 2;
+    }
+    ops *= 5;
+
+    std::vector<double> ns(samples);
+    for (double& sample : ns) {
+        auto t0 = clock::now();
+        for (uint64_t k = 0; k < ops; ++k) acc += op(i++);
+        sample = std::chrono::duration<double, std::nano>(clock::now() - t0).count() / double(ops);
+    }
+    sink = sink + acc;
+    std::sort(ns.begin(), ns.end());
+    Result r;
+    r.name = name;
+    r.ops = ops;
+    r.min = ns.front();
+    r.median = ns[ns.size() / 2];
+    r.p99 = ns[std::min(ns.size() - 1, ns.size() * 99 / 100)];
+    results.push_back(r);
+    printf("%-28s %12.1f %12.1f %12.1f\n", name, r.min, r.median, r.p99);
+    fflush(stdout);
+}
+
+// Pool of random hands, cycled through by the scoring benchmarks.
+const int HAND_POOL = 4096;
+uint8_t hand_pool[HAND_POOL][NUM_DICE];
+
+// Chi-square of single faces (5 degrees of freedom) and of consecutive pairs
+// (35) over 6M dice, against their 99.9% critical values.
+bool dice_uniform(DiceSource<Rng>& dice) {
+    const uint64_t DICE = 6000000;
+    uint64_t faces[6] = {}, pairs[36] = {};
+    int prev = dice.next() - 1;
+    for (uint64_t i = 0; i < DICE; ++i) {
+        const int d = dice.next() - 1;
+        faces[d]++;
+        pairs[prev * 6 + d]++;
+        prev = d;
+    }
+    double chi_faces = 0, chi_pairs = 0;
+    for (uint64_t n : faces) chi_faces += (double(n) - DICE / 6.0) * (double(n) - DICE / 6.0) / (DICE / 6.0);
+    for (uint64_t n : pairs) chi_pairs += (double(n) - DICE / 36.0) * (double(n) - DICE / 36.0) / (DICE / 36.0);
+    const bool uniform = chi_faces < 20.52 && chi_pairs < 66.62;
+    printf("dice/chi-square (6M dice)     faces %.2f (df 5), pairs %.2f (df 35): %s\n",
+           chi_faces, chi_pairs, uniform ? "ok" : "NOT UNIFORM");
+    return uniform;
+}
+
+bool write_json(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "{\n  \"samples\": %d,\n  \"solver_table\": %s,\n  \"distribution_table\": %s,\n  \"batch_isa\": \"%s\",\n  \"benchmarks\": [\n",
+            samples, solver_loaded() ? "true" : "false",
+            distribution_loaded() ? "true" : "false", batch_isa_name(batch_isa()));
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"ops_per_sample\": %llu, \"min_ns\": %.3f, \"median_ns\": %.3f, \"p99_ns\": %.3f}%s\n",
+                r.name.c_str(), (unsigned long long)r.ops, r.min, r.median, r.p99, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f) == 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const char* json = nullptr;
+    const char* table = DEFAULT_SOLVER_TABLE;
+    const char* dist_table = DEFAULT_DISTRIBUTION_TABLE;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--filter" && has_value) filter = argv[++i];
+        else if (arg == "--samples" && has_value) samples = std::max(1, atoi(argv[++i]));
+        else if (arg == "--json" && has_value) json = argv[++i];
+        else if (arg == "--solver-table" && has_value) table = argv[++i];
+        else if (arg == "--distribution-table" && has_value) dist_table = argv[++i];
+        else {
+            fprintf(stderr, "usage: bench [--filter text] [--samples N] [--json file] [--solver-table file]"
+                            " [--distribution-table file]\n");
+            return 1;
+        }
+    }
+    Rng rng(12345);
+    for (auto& hand : hand_pool)
+        for (uint8_t& die : hand) die = uint8_t(roll_die(rng));
+
+    printf("%-28s %12s %12s %12s\n", "benchmark (ns/op)", "min", "median", "p99");
+
+    // --- scoring ---
+    bench("score/hand_index", [](uint64_t i) {
+        return uint64_t(hand_index(hand_pool[i % HAND_POOL]));
+    });
+    bench("score/category_score x13", [](uint64_t i) {
+        uint64_t total = 0;
+        for (int c = 0; c < NUM_CATEGORIES; ++c) total += category_score(hand_pool[i % HAND_POOL], Category(c));
+        return total;
+    });
+    {
+        // one op = one hand with all 13 categories, in batches of 4096
+        static uint8_t dice_soa[NUM_DICE][HAND_POOL], out[NUM_CATEGORIES][HAND_POOL];
+        const uint8_t* dice[NUM_DICE];
+        uint8_t* scores[NUM_CATEGORIES];
+        for (int d = 0; d < NUM_DICE; ++d) {
+            for (int n = 0; n < HAND_POOL; ++n) dice_soa[d][n] = hand_pool[n][d];
+            dice[d] = dice_soa[d];
+        }
+        for (int c = 0; c < NUM_CATEGORIES; ++c) scores[c] = out[c];
+        uint8_t reference[NUM_CATEGORIES][HAND_POOL];
+        for (int n = 0; n < HAND_POOL; ++n)
+            for (int c = 0; c < NUM_CATEGORIES; ++c) reference[c][n] = uint8_t(category_score(hand_pool[n], Category(c)));
+        for (BatchIsa isa : { BATCH_SCALAR, BATCH_SSE2, BATCH_AVX2 }) {
+            if (isa > batch_isa()) continue;
+            score_batch(isa, dice, HAND_POOL, scores);
+            if (std::memcmp(out, reference, sizeof(out)) != 0) {
+                fprintf(stderr, "score_batch (%s) disagrees with category_score\n", batch_isa_name(isa));
+                return 1;
+            }
+            const std::string name = std::string("score/batch_") + batch_isa_name(isa);
+            bench(name.c_str(), [&](uint64_t i) {
+                if (i % HAND_POOL == 0) score_batch(isa, dice, HAND_POOL, scores);
+                return uint64_t(out[CHANCE][i % HAND_POOL]);
+            });
+        }
+    }
+
+    // --- dice ---
+    {
+        std::mt19937 mt(12345);
+        bench("dice/uniform_int_distribution", [&](uint64_t) {
+            // what the roll path used to do: a fresh distribution for every die
+            uint64_t total = 0;
+            for (int d = 0; d < NUM_DICE; ++d) total += std::uniform_int_distribution<int>(1, 6)(mt);
+            return total;
+        });
+        DiceSource<std::mt19937> mt_dice(mt);
+        bench("dice/DiceSource mt19937 hand", [&](uint64_t) {
+            uint8_t hand[NUM_DICE];
+            mt_dice.fill(hand);
+            return uint64_t(hand[0] + hand[4]);
+        });
+        DiceSource<Rng> dice(rng);
+        bench("dice/DiceSource Rng hand", [&](uint64_t) {
+            uint8_t hand[NUM_DICE];
+            dice.fill(hand);
+            return uint64_t(hand[0] + hand[4]);
+        });
+        bench("dice/roll Rng", [&](uint64_t) {
+            GameState g;
+            roll(g, dice);
+            return uint64_t(g.dice[0] + g.dice[4]);
+        });
+
+        if ((!filter || std::strstr("dice/chi-square", filter)) && !dice_uniform(dice)) return 1;
+    }
+
+    // --- rendering into the off-screen frame and an in-memory ANSI string ---
+    // (before the tables are loaded: with them, the odds lines on the scorecard
+    // would dominate the time; those queries are timed on their own below)
+    {
+        game = GameState();
+        for (int c = 0; c < NUM_CATEGORIES; c += 2) { roll(game, rng); score_into(game, Category(c)); }
+        roll(game, rng);
+        std::vector<Run> runs;
+        bench("render/draw_scorecard+dice", [&](uint64_t) {
+            clear_screen();
+            draw_scorecard();
+            draw_dice();
+            return uint64_t(screen.cursor_row());
+        });
+        bench("render/full frame to ansi", [&](uint64_t) {
+            screen.terminal_cleared();
+            clear_screen();
+            draw_scorecard();
+            draw_dice();
+            draw_commands_after_dice_roll();
+            draw_hold_advice();
+            screen.diff(runs);
+            return uint64_t(ansi_frame(runs, screen.cursor_row(), screen.cursor_col()).size());
+        });
+        bench("render/hold toggle to ansi", [&](uint64_t i) {
+            toggle_hold(game, int(i % NUM_DICE));
+            clear_screen();
+            draw_scorecard();
+            draw_dice();
+            draw_commands_after_dice_roll();
+            draw_hold_advice();
+            screen.diff(runs);
+            return uint64_t(ansi_frame(runs, screen.cursor_row(), screen.cursor_col()).size());
+        });
+    }
+
+    // --- save slots: one checkpoint per keypress, so it has to be quick ---
+    {
+        const char* path = "bench.save";
+        std::remove(path);
+        SaveFile saves;
+        if (saves.open(path)) {
+            const uint32_t SLOTS = 4096;
+            static Checkpoint slots[SLOTS];
+            GameState g;
+            roll(g, rng);
+            bench("save/checkpoint write", [&](uint64_t i) {
+                Checkpoint& c = slots[i % SLOTS];
+                toggle_hold(g, int(i % NUM_DICE));
+                set_checkpoint_game(c, g);
+                c.in_progress = 1;
+                return uint64_t(saves.save(uint32_t(i % SLOTS), c));
+            });
+            bench("save/checkpoint load", [&](uint64_t i) {
+                return saves.load(uint32_t(i % SLOTS)).sequence;
+            });
+            saves.close();
+        }
+        std::remove(path);
+    }
+
+    load_solver_table(table); // solver and optimal playout benchmarks are skipped without it
+    load_distribution_table(dist_table);
+
+    // --- headless playouts ---
+    // the rules alone: one roll a turn, scored in the first box it may go in
+    bench("playout/first legal game", [](uint64_t i) {
+        Rng game_rng = Rng::stream(1, i);
+        DiceSource<Rng> dice(game_rng);
+        GameState g;
+        while (!game_over(g)) {
+            roll(g, dice);
+            score_into(g, Category(lowest_bit(legal_categories(g))));
+        }
+        return uint64_t(grand_total(g));
+    });
+    const std::unique_ptr<Strategy> greedy = make_strategy("greedy"), optimal = make_strategy("optimal");
+    bench("playout/greedy game", [&](uint64_t i) {
+        Rng game_rng = Rng::stream(1, i);
+        DiceSource<Rng> dice(game_rng);
+        return uint64_t(grand_total(play_game(*greedy, dice)));
+    });
+    bench("playout/greedy crn game", [&](uint64_t i) {
+        return uint64_t(grand_total(play_crn_game(*greedy, 1, i)));
+    });
+    bench("playout/greedy yatzy game", [&](uint64_t i) {
+        Rng game_rng = Rng::stream(1, i);
+        DiceSource<Rng> dice(game_rng);
+        return uint64_t(play_greedy_variant<Yatzy>(dice));
+    });
+    bench("playout/greedy maxi game", [&](uint64_t i) {
+        Rng game_rng = Rng::stream(1, i);
+        DiceSource<Rng> dice(game_rng);
+        return uint64_t(play_greedy_variant<MaxiYatzy>(dice));
+    });
+    // --- reroll tables ---
+    static float hand_values[NUM_HANDS];
+    for (float& v : hand_values) v = float(roll_die(rng));
+    bench("reroll/keep_ev", [](uint64_t i) {
+        return uint64_t(keep_ev(int(i % NUM_KEEPS), hand_values));
+    });
+    bench("reroll/hold_ev 32 masks", [](uint64_t i) {
+        float best = 0.0f;
+        for (int mask = 0; mask < (1 << NUM_DICE); ++mask)
+            best = std::max(best, hold_ev(hand_pool[i % HAND_POOL], uint8_t(mask), hand_values));
+        return uint64_t(best);
+    });
+    // worst case for the move budget: a new state every time, nothing cached
+    const std::unique_ptr<Strategy> lookahead = make_strategy("lookahead");
+    bench("ai/lookahead hold (new state)", [&](uint64_t i) {
+        GameState g;
+        g.filled = uint16_t((i * 2654435761u) & ALL_CATEGORIES & ~(1u << CHANCE));
+        g.rolls = ROLLS_PER_TURN - 1;
+        set_dice(g, hand_pool[i % HAND_POOL]);
+        return uint64_t(lookahead->choose_hold(g));
+    });
+
+    if (optimal) {
+        bench("playout/optimal game", [&](uint64_t i) {
+            Rng game_rng = Rng::stream(1, i);
+            DiceSource<Rng> dice(game_rng);
+            return uint64_t(grand_total(play_game(*optimal, dice)));
+        });
+
+        // --- solver / advisor ---
+        static TurnValues tv;
+        bench("ai/compute_turn_values", [](uint64_t i) {
+            SolverState s;
+            s.filled = uint16_t((i * 2654435761u) & ALL_CATEGORIES & ~1u);
+            s.yahtzee50 = (s.filled >> YAHTZEE) & 1;
+            compute_turn_values(solver_table(), s, tv);
+            return uint64_t(tv.start);
+        });
+        GameState g;
+        for (int c = 0; c < 4; ++c) { roll(g, rng); score_into(g, Category(c * 3)); }
+        roll(g, rng);
+        // the dot products must agree with the solver's own keep values
+        const TurnValues& gtv = cached_turn_values(solver_state(g));
+        float worst = 0.0f;
+        for (int r = 1; r < ROLLS_PER_TURN; ++r)
+            for (int k = 0; k < NUM_KEEPS; ++k)
+                worst = std::max(worst, std::abs(keep_ev(k, gtv.hand[r - 1]) - gtv.keep[r - 1][k]));
+        printf("(reroll keep_ev vs solver keeps: max difference %g)\n", worst);
+        bench("ai/advise_holds (cached)", [&](uint64_t) {
+            HoldAdvice advice[3];
+            return uint64_t(advise_holds(g, advice, 3));
+        });
+        game = g;
+        bench("ai/expected_final_score (cached)", [](uint64_t) {
+            return uint64_t(expected_final_score());
+        });
+        if (distribution_loaded()) {
+            GameState start = g;
+            start.rolls = ROLLS_PER_TURN;
+            bench("ai/chance_at_least turn start", [&](uint64_t i) {
+                return uint64_t(1000.0f * chance_at_least(start, 150 + int(i % 200)));
+            });
+            bench("ai/chance_at_least mid-turn", [&](uint64_t i) {
+                return uint64_t(1000.0f * chance_at_least(g, 150 + int(i % 200)));
+            });
+        } else {
+            printf("(no distribution table: chance benchmarks skipped)\n");
+        }
+    } else {
+        printf("(no solver table: optimal playout and ai benchmarks skipped)\n");
+    }
+
+    if (json && !write_json(json)) {
+        fprintf(stderr, "Could not write %s\n", json);
+        return 1;
+    }
+    return 0;
+}
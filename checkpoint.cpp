@@ -0,0 +1,79 @@
+// CL_Yahtzee save slots
+
+#include "checkpoint.h"
+#include "raw_file.h"
+
+#include <cstddef>
+
+namespace {
+
+const char SAVE_MAGIC[8] = { 'C', 'L', 'Y', 'Z', 'S', 'V', '\0', '\0' };
+const uint32_t SAVE_VERSION = 2;      // 2: game start time
+
+struct SaveFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+};
+
+// copy 0 or 1 of a slot; the file grows (sparsely) as slots are first written
+uint64_t copy_offset(uint32_t slot, uint64_t sequence) {
+    return sizeof(SaveFileHeader) + (uint64_t(slot) * 2 + (sequence & 1)) * sizeof(Checkpoint);
+}
+
+bool checkpoint_valid(const Checkpoint& c) {
+    return c.checksum == checksum(&c, offsetof(Checkpoint, checksum)) && c.sequence > 0 &&
+           c.rolls <= ROLLS_PER_TURN && c.turn <= NUM_TURNS && c.dice_left <= 24; // 24 dice per generator call
+}
+
+} // namespace
+
+bool SaveFile::open(const char* path) {
+    close();
+    fd = open_file(path, true);
+    if (fd < 0) return false;
+    SaveFileHeader header;
+    const int64_t size = file_size(fd);
+    bool ok = size >= 0;
+    if (ok && size < int64_t(sizeof(header))) {
+        std::memcpy(header.magic, SAVE_MAGIC, sizeof(header.magic));
+        header.version = SAVE_VERSION;
+        header.record_size = sizeof(Checkpoint);
+        ok = truncate_file(fd, 0) && write_at(fd, &header, sizeof(header), 0) && sync_file(fd);
+    } else if (ok) {
+        ok = read_at(fd, &header, sizeof(header), 0) &&
+             std::memcmp(header.magic, SAVE_MAGIC, sizeof(header.magic)) == 0 &&
+             header.version == SAVE_VERSION && header.record_size == sizeof(Checkpoint);
+    }
+    if (!ok) close();
+    return ok;
+}
+
+void SaveFile::close() {
+    if (fd >= 0) close_file(fd);
+    fd = -1;
+}
+
+Checkpoint SaveFile::load(uint32_t slot) const {
+    Checkpoint newest;
+    std::memset(&newest, 0, sizeof(newest));
+    if (fd < 0 || slot >= MAX_SAVE_SLOTS) return newest;
+    for (uint64_t copy = 0; copy < 2; ++copy) {
+        Checkpoint c;
+        if (read_at(fd, &c, sizeof(c), copy_offset(slot, copy)) && checkpoint_valid(c) &&
+            (c.sequence & 1) == copy && c.sequence > newest.sequence)
+            newest = c;
+    }
+    return newest;
+}
+
+bool SaveFile::save(uint32_t slot, Checkpoint& c) {
+    if (fd < 0 || slot >= MAX_SAVE_SLOTS) return false;
+    c.sequence++;
+    c.checksum = checksum(&c, offsetof(Checkpoint, checksum));
+    return write_at(fd, &c, sizeof(c), copy_offset(slot, c.sequence));
+}
+
+bool SaveFile::sync() {
+    return fd >= 0 && sync_file(fd);
+}
@@ -0,0 +1,88 @@
+// CL_Yahtzee save slots
+// A game in progress is checkpointed after every action (roll, hold, score):
+// the whole game (scorecard, dice, holds, rolls left, turn) and the dice
+// generator go into one fixed-size record, at an offset computed from the
+// slot number, so a save file holds thousands of slots without an index and a
+// checkpoint is a single small write (a few microseconds).
+//
+// Crash safety: each slot has two copies, written in turn and carrying a
+// sequence number and a checksum. A write cut short can only damage the copy
+// it was writing; the other one, one action older, is read back instead.
+// Checkpoints aren't synced: once written the OS has them, so a crashed or
+// killed game loses nothing (only a power cut can lose the last few actions).
+
+#pragma once
+
+#include "yahtzee.h"
+
+#include <cstring>
+
+const char* const DEFAULT_SAVE_FILE = "cl_yahtzee.save";
+const uint32_t MAX_SAVE_SLOTS = 65536;
+
+struct Checkpoint {
+    uint64_t sequence;                  // writes to this slot so far: the newer copy wins
+    uint64_t seed;                      // dice seed (as in the replay log)
+    uint64_t started;                   // when the game began (names its replay log)
+    uint64_t rng_state;                 // the dice generator...
+    uint64_t dice_digits;               // ...and the dice it has drawn but not rolled yet
+    uint16_t filled;
+    uint16_t replay_events;             // events logged so far, to pick the replay log up too
+    uint8_t score[NUM_CATEGORIES];
+    uint8_t dice[NUM_DICE];
+    uint8_t held;
+    uint8_t rolls;
+    uint8_t yahtzee_bonuses;
+    uint8_t dice_left;
+    uint8_t turn;
+    uint8_t in_progress;                // 0 once the game is over (or the slot was never used)
+    uint32_t checksum;                  // of everything above
+};
+static_assert(sizeof(Checkpoint) == 72, "records are written as is");
+
+inline GameState checkpoint_game(const Checkpoint& c) {
+    GameState g;
+    std::memcpy(g.score, c.score, sizeof(g.score));
+    set_dice(g, c.dice);
+    g.filled = c.filled;
+    g.held = c.held;
+    g.rolls = c.rolls;
+    g.yahtzee_bonuses = c.yahtzee_bonuses;
+    return g;
+}
+
+inline void set_checkpoint_game(Checkpoint& c, const GameState& g) {
+    std::memcpy(c.score, g.score, sizeof(c.score));
+    std::memcpy(c.dice, g.dice, sizeof(c.dice));
+    c.filled = g.filled;
+    c.held = g.held;
+    c.rolls = g.rolls;
+    c.yahtzee_bonuses = g.yahtzee_bonuses;
+}
+
+class SaveFile {
+public:
+    SaveFile() = default;
+    SaveFile(const SaveFile&) = delete;
+    SaveFile& operator=(const SaveFile&) = delete;
+    ~SaveFile() { close(); }
+
+    // Opens (or creates) a save file. It stays open for quick checkpoints.
+    bool open(const char* path = DEFAULT_SAVE_FILE);
+    void close();
+    bool is_open() const { return fd >= 0; }
+
+    // The newest intact copy of slot (all zero if it was never written).
+    // Keep it to save to the slot: save continues its sequence.
+    Checkpoint load(uint32_t slot) const;
+
+    // Writes c to slot over its older copy, after advancing c's sequence and
+    // setting its checksum.
+    bool save(uint32_t slot, Checkpoint& c);
+    // Waits for the saved copies to reach the disk (for the odd save a power
+    // cut mustn't undo, like the one ending a game).
+    bool sync();
+
+private:
+    int fd = -1;
+};
@@ -2,63 +2,27 @@
 // Command Line Yahtzee Game, Developed by Jason Wu
 
 #include <iostream>
-#include <windows.h>
-
-// --- Console VT (ANSI) enable + fallback ---
-static bool VT_ENABLED = false;
-static HANDLE HOUT = GetStdHandle(STD_OUTPUT_HANDLE);
-static WORD DEFAULT_ATTRS = 0;
-
-bool enable_vt()
-{
-    DWORD mode = 0;
-    if (!GetConsoleMode(HOUT, &mode)) return false;
-    // Save default attributes
-    CONSOLE_SCREEN_BUFFER_INFO info{};
-    if (GetConsoleScreenBufferInfo(HOUT, &info)) DEFAULT_ATTRS = info.wAttributes;
-    // Try to enable VT
-    DWORD newMode = mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING;
-    if (!SetConsoleMode(HOUT, newMode)) return false;
-    VT_ENABLED = true;
-    return true;
-}
-
-void clr_screen()
-{
-    if (VT_ENABLED) {
-        std::cout << "\033[2J\033[H";
-    } else {
-        system("cls"); // legacy fallback
-    }
-}
-
-void move_to(short r, short c) {
-    COORD pos{ static_cast<SHORT>(c - 1), static_cast<SHORT>(r - 1) };
-    SetConsoleCursorPosition(GetStdHandle(STD_OUTPUT_HANDLE), pos);
-}
-
-enum Color { NORMAL, YELLOW, RED };
-void set_color(Color c)
-{
-    if (VT_ENABLED) {
-        if (c == YELLOW) std::cout << "\033[33m";
-        else if (c == RED) std::cout << "\033[31m";
-        else std::cout << "\033[0m";
-    } else {
-        WORD attr = DEFAULT_ATTRS;
-        if (c == YELLOW) attr = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY;
-        if (c == RED)    attr = FOREGROUND_RED | FOREGROUND_INTENSITY;
-        SetConsoleTextAttribute(HOUT, attr);
-    }
-}
-void reset_color() { set_color(NORMAL); }
-
 #include <random>
-#include <conio.h>
+#include <cstdio>
 #include <algorithm>
 #include <set>
 #include <thread>
 #include <chrono>
+#include <ctime>
+
+#include "terminal.h"
+#include "yahtzee.h"
+#include "solver.h"
+#include "simulate.h"
+#include "replay.h"
+#include "draw.h"
+#include "latency.h"
+#include "server.h"
+#include "distribution.h"
+#include "compact_table.h"
+#include "stats.h"
+#include "checkpoint.h"
+#include "raw_file.h"
 
 using namespace std;
 
@@ -70,318 +34,648 @@ const string CLEAR_LINE = "\033[2K";
 const string HIDE_CURSOR = "\033[?25l";
 const string SHOW_CURSOR = "\033[?25h";
 
-// initialize scorecard values
-// upper section
-int ones = 0; bool ones_final = false; // final score for each section
-int twos = 0; bool twos_final = false;
-int threes = 0; bool threes_final = false;
-int fours = 0; bool fours_final = false;
-int fives = 0; bool fives_final = false;
-int sixes = 0; bool sixes_final = false;
-int upper_section_bonus = 0; int upper_section_bonus_final = false;
-int upper_total = 0;
-// lower section
-int three_of_a_kind = 0; bool three_of_a_kind_final = false; // final score for each section
-int four_of_a_kind = 0; bool four_of_a_kind_final = false;
-int full_house = 0; bool full_house_final = false;
-int sml_straight = 0; bool sml_straight_final = false;
-int lrg_straight = 0; bool lrg_straight_final = false;
-int yahtzee = 0; bool yahtzee_final = false;
-int chance = 0; bool chance_final = false;
-// int yahtzee_bonus = 0; (to be implemented soon)
-int lower_total = 0;
-
-int grand_total = 0;
-
-// initialize dice values
-int d1 = 0; bool d1h = false; // hold status for each die
-int d2 = 0; bool d2h = false;
-int d3 = 0; bool d3h = false;
-int d4 = 0; bool d4h = false;
-int d5 = 0; bool d5h = false;
-int rolls = 3;
-
-// Forward declarations for potential score helper functions
-int count_dice_with_value(int val);
-int potential_three_of_a_kind();
-int potential_four_of_a_kind();
-bool is_full_house();
-bool is_small_straight();
-bool is_large_straight();
-bool is_yahtzee();
-
-// seed rng
+// seed rng: game dice come from a seeded Rng so a replay log can reproduce them;
+// the rolling animation has its own generator and never touches the game's
 std::random_device rd;
-std::mt19937 rng(rd());
-
-void clear_screen() {
-    cout << CLEAR_SCREEN << CURSOR_HOME;
+Rng rng;
+DiceSource<Rng> dice(rng);
+Rng anim_rng((uint64_t(rd()) << 32) | rd());
+DiceSource<Rng> anim_dice(anim_rng);
+
+// every game is logged as it's played (see replay.h)
+ReplayWriter recorder;
+
+// and checkpointed to its save slot after every action (see checkpoint.h)
+SaveFile saves;
+uint32_t save_slot = 0;
+Checkpoint saved{};                      // the slot's last checkpoint (save goes on from its sequence)
+
+// Checkpoints g as the state of the game at turn, with the dice generator
+// and the replay log as they are now.
+void save_game(int turn, const GameState& g) {
+    if (!saves.is_open()) return;
+    set_checkpoint_game(saved, g);
+    saved.rng_state = rng.state;
+    saved.dice_digits = dice.buffered_digits();
+    saved.dice_left = uint8_t(dice.buffered());
+    saved.turn = uint8_t(turn);
+    saved.replay_events = uint16_t(recorder.events());
+    saved.in_progress = 1;
+    saves.save(save_slot, saved);
 }
 
-void flush_output_buffer() {
-    cout << flush;
+// Scores the turn into slot and checkpoints the start of the next one.
+void score_turn(int turn, Category slot) {
+    score_into(game, slot);
+    recorder.score(slot);
+    GameState next = game;
+    start_turn(next);
+    save_game(turn + 1, next);
 }
 
-// finalization helper functions
-bool all_upper_final() {
-    return ones_final && twos_final && threes_final && fours_final && fives_final && sixes_final;
-}
-bool all_lower_final() {
-    return three_of_a_kind_final && four_of_a_kind_final && full_house_final &&
-           sml_straight_final && lrg_straight_final && yahtzee_final && chance_final;
-}
+// frame-to-frame changes, reused to avoid reallocating every flush
+std::vector<Run> changed_runs;
 
-void draw_scorecard() {
-    cout << "\033[1;1H" << "CL_Yahtzee v1.0 | Developed by Jason Wu" << endl << endl;
-
-    cout << "Scorecard" << endl;
-    cout << "-------------------" << endl;
-    
-    // Upper Section
-    cout << "UPPER SECTION" << endl;
-    cout << "1s: " << (ones_final ? "\033[33m" : "") << ones << "\033[0m";
-    if (!ones_final && rolls < 3) cout << "\b(" << count_dice_with_value(1) * 1 << ")"; // applied backspace chars
-    cout << endl;
-    cout << "2s: " << (twos_final ? "\033[33m" : "") << twos << "\033[0m";
-    if (!twos_final && rolls < 3) cout << "\b(" << count_dice_with_value(2) * 2 << ")";
-    cout << endl;
-    cout << "3s: " << (threes_final ? "\033[33m" : "") << threes << "\033[0m";
-    if (!threes_final && rolls < 3) cout << "\b(" << count_dice_with_value(3) * 3 << ")";
-    cout << endl;
-    cout << "4s: " << (fours_final ? "\033[33m" : "") << fours << "\033[0m";
-    if (!fours_final && rolls < 3) cout << "\b(" << count_dice_with_value(4) * 4 << ")";
-    cout << endl;
-    cout << "5s: " << (fives_final ? "\033[33m" : "") << fives << "\033[0m";
-    if (!fives_final && rolls < 3) cout << "\b(" << count_dice_with_value(5) * 5 << ")";
-    cout << endl;
-    cout << "6s: " << (sixes_final ? "\033[33m" : "") << sixes << "\033[0m";
-    if (!sixes_final && rolls < 3) cout << "\b(" << count_dice_with_value(6) * 6 << ")";
-    cout << endl;
-    upper_total = ones + twos + threes + fours + fives + sixes;
-    if (upper_total >= 63) {
-        upper_section_bonus = 35; // bonus for scoring 63 or more
-        if (all_upper_final) upper_section_bonus_final = true; // finalizing upper section bonus
+void flush_output_buffer() {
+    screen.diff(changed_runs);
+    size_t bytes = 0;
+    if (vt_enabled()) {
+        string out = ansi_frame(changed_runs, screen.cursor_row(), screen.cursor_col());
+        write_output(out.data(), out.size());
+        bytes = out.size();
     } else {
-        upper_section_bonus = 0;
-        if (all_upper_final) upper_section_bonus_final = true;
+        for (const Run& run : changed_runs) {
+            move_to(short(run.row), short(run.col));
+            set_color(run.color);
+            write_output(run.text.data(), run.text.size());
+            bytes += run.text.size();
+        }
+        set_color(NORMAL);
+        move_to(short(screen.cursor_row()), short(screen.cursor_col()));
     }
-    cout << "Upper Section Bonus: ";
-    if (all_upper_final()) cout << "\033[33m";
-    cout << upper_section_bonus << "\033[0m" << endl; // changed formatting of all finalized totals
-    cout << "Upper Total: ";
-    if (all_upper_final()) cout << "\033[33m";
-    cout << upper_total + upper_section_bonus << "\033[0m" << endl;
-
-    // Lower Section
-    cout << "\033[5;26H" << "| LOWER SECTION" << endl;
-    cout << "\033[6;26H" << "| 3 of a Kind: " << (three_of_a_kind_final ? "\033[33m" : "") << three_of_a_kind << "\033[0m";
-    if (!three_of_a_kind_final && rolls < 3) cout << "\b(" << potential_three_of_a_kind() << ")";
-    cout << endl;
-    cout << "\033[7;26H" << "| 4 of a Kind: " << (four_of_a_kind_final ? "\033[33m" : "") << four_of_a_kind << "\033[0m";
-    if (!four_of_a_kind_final && rolls < 3) cout << "\b(" << potential_four_of_a_kind() << ")";
-    cout << endl;
-    cout << "\033[8;26H" << "| Full House: " << (full_house_final ? "\033[33m" : "") << full_house << "\033[0m";
-    if (!full_house_final && rolls < 3) cout << "\b(" << (is_full_house() ? 25 : 0) << ")";
-    cout << endl;
-    cout << "\033[9;26H" << "| Small Straight: " << (sml_straight_final ? "\033[33m" : "") << sml_straight << "\033[0m";
-    if (!sml_straight_final && rolls < 3) cout << "\b(" << (is_small_straight() ? 30 : 0) << ")";
-    cout << endl;
-    cout << "\033[10;26H" << "| Large Straight: " << (lrg_straight_final ? "\033[33m" : "") << lrg_straight << "\033[0m";
-    if (!lrg_straight_final && rolls < 3) cout << "\b(" << (is_large_straight() ? 40 : 0) << ")";
-    cout << endl;
-    cout << "\033[11;26H" << "| Yahtzee: " << (yahtzee_final ? "\033[33m" : "") << yahtzee << "\033[0m";
-    if (!yahtzee_final && rolls < 3) cout << "\b(" << (is_yahtzee() ? 50 : 0) << ")";
-    cout << endl;
-    cout << "\033[12;26H" << "| Chance: " << (chance_final ? "\033[33m" : "") << chance << "\033[0m";
-    if (!chance_final && rolls < 3) cout << "\b(" << (d1 + d2 + d3 + d4 + d5) << ")";
-    cout << endl;
-
-    lower_total = three_of_a_kind + four_of_a_kind + full_house + sml_straight + lrg_straight + yahtzee + chance;
-    grand_total = upper_total + upper_section_bonus + lower_total;
-    if (all_lower_final())
-        cout;
-    cout << "\033[13;26H" << "| Lower Total: "; 
-    if (all_lower_final()) cout << "\033[33m";
-    cout << lower_total << "\033[0m" << endl;
-    cout << "-------------------" << endl; //    ...including these two as well.
-    cout << "Grand Total: ";
-    if (all_upper_final() && all_lower_final()) cout << "\033[33m";
-    cout << grand_total << "\033[0m" << endl;
-    cout << "-------------------" << endl << endl;
-    flush_output_buffer();
+    latency_flush_end(bytes);
 }
 
-void draw_dice() {
-    cout << "\033[18;1H" << "Dice: ";
-    if (rolls == 0) cout << "\033[31m"; // RED if no rolls left
-    cout << rolls << " ROLL(S) LEFT";
-    if (rolls == 0) cout << "\033[0m";
-    cout << endl << endl;
-    cout << "   " << d1 << "   " << d2 << "   " << d3 << "   " << d4 << "   " << d5 << endl;
-    cout << "   " << (d1h ? "H" : " ") << "   " << (d2h ? "H" : " ") << "   " << (d3h ? "H" : " ") << "   " << (d4h ? "H" : " ") << "   " << (d5h ? "H" : " ") << endl;
-    cout << "-------------------" << endl;
+// Dice rolling animation: the dice are rolled at once and the animation only
+// plays over the result, on a fixed frame clock (frame n is due at start + n
+// frames; a late frame skips ahead rather than pushing the rest back). Keys
+// stay live throughout: get_key waits for a key or the next frame, whichever
+// comes first, and a key ends the animation on the real dice.
+const int ANIM_FRAMES = 30;
+const chrono::milliseconds ANIM_FRAME_TIME(10);
+
+struct DiceAnimation {
+    GameState before;                    // the screen keeps showing the scorecard from before the roll
+    uint8_t faces[NUM_DICE];             // what the rolling dice show this frame
+    int frame = -1;                      // frame on screen, -1 when not rolling
+    chrono::steady_clock::time_point start;
+} rolling;
+
+bool dice_rolling() { return rolling.frame >= 0; }
+
+// call just before rolling g
+void start_dice_animation(const GameState& g) {
+    rolling.before = g;
+    rolling.frame = 0;
+    rolling.start = chrono::steady_clock::now();
+    std::copy(g.dice, g.dice + NUM_DICE, rolling.faces);
+    anim_dice.fill(rolling.faces, g.held);
+    latency_anim_frame(ANIM_FRAME_TIME.count() * 1000);
 }
 
+void stop_dice_animation() {
+    rolling.frame = -1;
+    latency_anim_end();
+}
 
-void draw_commands_before_first_roll() {
-    cout << "\033[23;1H" << "[Space] : Roll all dice" << endl << endl;
+chrono::steady_clock::time_point next_frame_due() {
+    return rolling.start + (rolling.frame + 1) * ANIM_FRAME_TIME;
 }
 
-void draw_commands_after_dice_roll() {
-    cout << "\033[23;1H";
-    cout << "[1] Hold D1    [4] Hold D4" << endl;
-    cout << "[2] Hold D2    [5] Hold D5" << endl;
-    cout << "[3] Hold D3    [0] Submit" << endl;
-    cout << "[Space] Reroll all unheld dice" << endl << endl;
+// Moves on to the frame that's due now (skipping any missed). False once the animation is over.
+bool advance_dice_animation() {
+    const int due = int((chrono::steady_clock::now() - rolling.start) / ANIM_FRAME_TIME);
+    if (due >= ANIM_FRAMES) { stop_dice_animation(); return false; }
+    latency_anim_frame((due - rolling.frame) * ANIM_FRAME_TIME.count() * 1000);
+    rolling.frame = due;
+    anim_dice.fill(rolling.faces, rolling.before.held);
+    return true;
 }
 
+// the dice as they're rolling (held ones stay put)
+void draw_rolling_dice() {
+    const GameState real = game;
+    game = rolling.before;
+    set_dice(game, rolling.faces);
+    draw_dice();
+    game = real;
+}
 
-void draw_commands_select_section(int r) {
-    cout << "\033[23;1H" << "Select Section:" << endl;
-    cout << "[1] Upper Section    [2] Lower Section" << endl;
-    // cout << (r != 0 ? "[0] Return to previous menu" : "") << endl << endl;
-    if (r != 0) {
-        cout << "[0] Return to previous menu" << endl << endl;
-    } else {
-        cout << endl << endl;
+// scorecard and dice: the real ones, or while the dice roll, the scorecard of before the roll
+void draw_game() {
+    clear_screen();
+    if (!dice_rolling()) {
+        draw_scorecard();
+        draw_dice();
+        return;
     }
+    const GameState real = game;
+    game = rolling.before;
+    draw_scorecard();
+    game = real;
+    draw_rolling_dice();
 }
 
-
-void draw_commands_select_upper_section() {
-    cout << "\033[23;1H" << "Select slot from Upper Section:" << endl;
-    if (!ones_final || !fours_final) // fixed indenting issues
-        cout << ( !ones_final ? "[1] 1s" : "      ") << "         " << ( !fours_final ? "[4] 4s" : "" ) << endl;
-    if (!twos_final || !fives_final)
-        cout << ( !twos_final ? "[2] 2s" : "      ") << "         " << ( !fives_final ? "[5] 5s" : "" ) << endl;
-    if (!threes_final || !sixes_final)
-        cout << ( !threes_final ? "[3] 3s" : "      ") << "         " << ( !sixes_final ? "[6] 6s" : "" ) << endl;
-    cout << "[0] Return to previous menu" << endl << endl;
+// every key goes through here so the latency log can time the response to it.
+// While the dice roll it also draws the animation's frames until a key comes;
+// if the animation ends first it returns 0 (no key) so the caller redraws.
+char get_key() {
+    while (dice_rolling()) {
+        const auto wait = chrono::ceil<chrono::milliseconds>(next_frame_due() - chrono::steady_clock::now());
+        if (key_ready(int(std::max<int64_t>(wait.count(), 0)))) {
+            stop_dice_animation(); // cut short to the real dice
+            break;
+        }
+        if (!advance_dice_animation()) return 0;
+        latency_draw_start();
+        draw_rolling_dice();
+        flush_output_buffer();
+    }
+    const char key = read_key();
+    latency_input();
+    return key;
 }
 
-void draw_commands_select_lower_section() {
-    cout << "\033[23;1H" << "Select slot from Lower Section:" << endl;
-    // First column: 3K, FH, LS, Chance. Second: 4K, SS, Yahtzee
-    if (!three_of_a_kind_final || !four_of_a_kind_final) // fixed indenting issues
-        cout << ( !three_of_a_kind_final ? "[1] 3 of a Kind   " : "                  ")
-             << "   " << ( !four_of_a_kind_final ? "[2] 4 of a Kind" : "" ) << endl;
-    if (!full_house_final || !sml_straight_final)
-        cout << ( !full_house_final ? "[3] Full House    " : "                  ")
-             << "   " << ( !sml_straight_final ? "[4] Small Straight" : "" ) << endl;
-    if (!lrg_straight_final || !yahtzee_final)
-        cout << ( !lrg_straight_final ? "[5] Large Straight" : "                  ")
-             << "   " << ( !yahtzee_final ? "[6] Yahtzee" : "" ) << endl;
-    if (!chance_final)
-        cout << "[7] Chance" << endl;
-    cout << "[0] Return to previous menu" << endl << endl;
+// Replays have no keys to wait for: the animation plays through on the same clock.
+void animate_dice_roll() {
+    start_dice_animation(game);
+    do {
+        latency_draw_start();
+        draw_rolling_dice();
+        flush_output_buffer();
+        std::this_thread::sleep_until(next_frame_due());
+    } while (advance_dice_animation());
 }
 
-// Dice rolling animation
-void animate_dice_roll() {
-    int temp_d1 = d1, temp_d2 = d2, temp_d3 = d3, temp_d4 = d4, temp_d5 = d5;
-    for (int i = 0; i < 30; ++i) {
-        if (!d1h) temp_d1 = std::uniform_int_distribution<int>(1, 6)(rng);
-        if (!d2h) temp_d2 = std::uniform_int_distribution<int>(1, 6)(rng);
-        if (!d3h) temp_d3 = std::uniform_int_distribution<int>(1, 6)(rng);
-        if (!d4h) temp_d4 = std::uniform_int_distribution<int>(1, 6)(rng);
-        if (!d5h) temp_d5 = std::uniform_int_distribution<int>(1, 6)(rng);
-
-        // Draw animation frame
-
-        // temporarily override global values for animation only
-        int old_d1 = d1, old_d2 = d2, old_d3 = d3, old_d4 = d4, old_d5 = d5;
-        d1 = temp_d1; d2 = temp_d2; d3 = temp_d3; d4 = temp_d4; d5 = temp_d5;
+// Plays a recorded game back at normal speed: each hold, roll and scoring choice
+// is drawn the way it looked when it was played.
+void show_replay(const Replay& replay) {
+    const auto pause = [] { std::this_thread::sleep_for(std::chrono::milliseconds(700)); };
+    Rng replay_rng(replay.seed);
+    DiceSource<Rng> replay_dice(replay_rng);
+    game = GameState();
+    enable_vt();
+    clr_screen();
+    screen.terminal_cleared();
+
+    size_t n = 0;
+    for (; n < replay.events.size(); ++n) {
+        const uint8_t event = replay.events[n];
+        string note;
+        if (is_roll_event(event)) {
+            if (has_rolled(game) && event != game.held) {
+                game.held = event; // show the holds before the dice move
+                clear_screen();
+                draw_scorecard();
+                draw_dice();
+                flush_output_buffer();
+                pause();
+            }
+            if (game.rolls > 0) animate_dice_roll();
+        } else if (event - REPLAY_SCORE < NUM_CATEGORIES) {
+            const Category c = Category(event - REPLAY_SCORE);
+            note = "Scored " + to_string(potential_score(game, c)) + " points to " + CATEGORY_NAMES[c];
+        }
+        if (!apply_replay_event(game, replay_dice, event)) break;
+        clear_screen();
+        draw_scorecard();
         draw_dice();
-        d1 = old_d1; d2 = old_d2; d3 = old_d3; d4 = old_d4; d5 = old_d5;
-
+        screen << at(23, 1) << "Replay: move " << int(n + 1) << " of " << int(replay.events.size()) << '\n' << note << '\n';
         flush_output_buffer();
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        pause();
     }
-}
 
-void show_cursor() {
-    cout << SHOW_CURSOR;
+    clear_screen();
+    draw_scorecard();
+    if (n < replay.events.size()) screen << "Replay stopped: move " << int(n + 1) << " is not legal here." << '\n';
+    screen << "Replay over! Press any key to exit..." << '\n';
+    flush_output_buffer();
+    get_key();
 }
 
-void hide_cursor() {
-    cout << HIDE_CURSOR;
+// Computer opponents for --players, weakest first: the name to ask for one,
+// the strategy that plays it and the tag its seat is named with.
+struct AiLevel { const char* name; const char* strategy; const char* tag; };
+const AiLevel AI_LEVELS[] = {
+    { "easy", "greedy", "Easy" }, { "medium", "upper", "Med" },
+    { "hard", "lookahead", "Hard" }, { "optimal", "optimal", "Opt" },
+};
+
+// how long each AI move stays on screen when someone's watching
+const chrono::milliseconds AI_MOVE_PAUSE(700);
+
+// Any key cuts the pause after an AI move short. False on Escape or Ctrl-C.
+bool ai_pause() {
+    if (!key_ready(int(AI_MOVE_PAUSE.count()))) return true;
+    const char key = get_key();
+    return key != 27 && key != 3;
 }
 
-// Helper functions for potential scores
-int count_dice_with_value(int val) {
-    int arr[5] = {d1, d2, d3, d4, d5};
-    int cnt = 0;
-    for (int i = 0; i < 5; ++i) if (arr[i] == val) cnt++;
-    return cnt;
+// One turn of the seat to move, played by ai. With people watching, each roll
+// and the choice of category stay up for a moment; otherwise it's over at once.
+bool play_ai_turn(const Strategy& ai, bool watched) {
+    const string& name = seats[seat_to_move].name;
+    const auto show = [&](const string& note) {
+        if (!watched) return true;
+        draw_game();
+        screen << at(23, 1) << note << '\n';
+        flush_output_buffer();
+        return ai_pause();
+    };
+    start_turn(game);
+    roll(game, dice);
+    if (!show(name + " rolls.")) return false;
+    while (game.rolls > 0) {
+        const uint8_t hold = ai.choose_hold(game);
+        if (hold == (1 << NUM_DICE) - 1) break;
+        string held;
+        for (int i = 0; i < NUM_DICE; ++i)
+            if ((hold >> i) & 1) held += " D" + to_string(i + 1);
+        game.held = hold;
+        roll(game, dice);
+        if (!show(name + (hold ? " holds" + held + " and rolls again." : " rerolls everything."))) return false;
+    }
+    const Category c = ai.choose_category(game);
+    const bool go_on = show(name + " scores " + to_string(potential_score(game, c)) + " points to " + CATEGORY_NAMES[c] + ".");
+    score_into(game, c);
+    return go_on;
 }
 
-int potential_three_of_a_kind() {
-    int arr[6] = {0};
-    int dice[5] = {d1, d2, d3, d4, d5};
-    for (int i = 0; i < 5; ++i) arr[dice[i]-1]++;
-    for (int i = 0; i < 6; ++i) if (arr[i] >= 3) return d1 + d2 + d3 + d4 + d5;
-    return 0;
-}
+// One turn of the seat to move, played from the keyboard (or picked up where
+// a saved game left it, if resume is set). False if the player quit.
+bool play_human_turn(int turn, const StatsStore& stats, bool resume) {
+    char cmd = ' ';
+    bool can_roll = true;
+    bool turn_complete = false;
+    if (!resume) start_turn(game);
+
+    while (!turn_complete) {
+        // ROLLING PHASE
+        bool submitted = false;
+        can_roll = true;
+        while (can_roll && !submitted) {
+            draw_game();
+            if (!has_rolled(game)) draw_commands_before_first_roll();
+            else draw_commands_after_dice_roll();
+            if (has_rolled(game) && !dice_rolling()) draw_hold_advice();
+            if (turn == 0 && !has_rolled(game)) draw_stats(stats, 25);
+            flush_output_buffer();
+
+            cmd = get_key();
+            if (cmd == ' ' && game.rolls > 0) {
+                start_dice_animation(game);
+                recorder.roll(game.held);
+                roll(game, dice);
+                save_game(turn, game);
+                if (game.rolls == 0) can_roll = false;
+            } else if (cmd >= '1' && cmd <= '5' && has_rolled(game)) {
+                toggle_hold(game, cmd - '1');
+                save_game(turn, game);
+            } else if (cmd == '0' && has_rolled(game)) {
+                // replace with break for bugfix
+                break;
+            } else if (cmd == 27 || cmd == 3) {
+                return false;
+            }
+        }
+
+        // SCORING PHASE
+        while (true) {
+            draw_game(); // the last roll may still be animating
+            draw_commands_select_section(game.rolls);
+            flush_output_buffer();
+            cmd = get_key();
+
+            if (cmd == 27 || cmd == 3) return false;
+            if (cmd == '0' && game.rolls > 0) break; // Go back to dice rolling with same dice/rolls (if rolls greater than 0)
+
+            bool scored = false;
+            if (cmd == '1') {
+                // UPPER SECTION SELECTION
+                while (true) {
+                    clear_screen();
+                    draw_scorecard();
+                    draw_dice();
+                    draw_commands_select_upper_section();
+                    flush_output_buffer();
+                    cmd = get_key();
+                    bool valid = false;
+                    int points = 0;
+                    string slot_name;
+                    Category slot = Category(ONES + (cmd - '1'));
+                    if (cmd >= '1' && cmd <= '6' && ((legal_categories(game) >> slot) & 1)) {
+                        points = potential_score(game, slot);
+                        slot_name = CATEGORY_NAMES[slot];
+                    } else if (cmd == 27 || cmd == 3) {
+                        return false;
+                    }
+                    if (cmd == '0') break;
 
-int potential_four_of_a_kind() {
-    int arr[6] = {0};
-    int dice[5] = {d1, d2, d3, d4, d5};
-    for (int i = 0; i < 5; ++i) arr[dice[i]-1]++;
-    for (int i = 0; i < 6; ++i) if (arr[i] >= 4) return d1 + d2 + d3 + d4 + d5;
-    return 0;
-}
+                    if (!slot_name.empty()) {
+                        // redraw commands section before drawing confirmation message
+                        clear_screen();
+                        draw_scorecard();
+                        draw_dice();
+                        screen << "Confirm submission of " << points << " points to " << slot_name << "?\n";
+                        screen << "[1] Yes   [0] No" << '\n';
+                        flush_output_buffer();
+                        char confirm = get_key();
+                        if (confirm == '1') {
+                            score_turn(turn, slot);
+                            valid = true;
+                        }
+                    }
+                    if (valid) { scored = true; break; }
+                }
+            } else if (cmd == '2') {
+                // LOWER SECTION SELECTION
+                while (true) {
+                    clear_screen();
+                    draw_scorecard();
+                    draw_dice();
+                    draw_commands_select_lower_section();
+                    flush_output_buffer();
+                    cmd = get_key();
+                    bool valid = false;
+                    int points = 0;
+                    string slot_name;
+                    Category slot = Category(THREE_OF_A_KIND + (cmd - '1'));
+                    if (cmd >= '1' && cmd <= '7' && ((legal_categories(game) >> slot) & 1)) {
+                        points = potential_score(game, slot);
+                        slot_name = CATEGORY_NAMES[slot];
+                    } else if (cmd == 27 || cmd == 3) {
+                        return false;
+                    }
+                    if (cmd == '0') break;
 
-bool is_full_house() {
-    int arr[6] = {0};
-    int dice[5] = {d1, d2, d3, d4, d5};
-    for (int i = 0; i < 5; ++i) arr[dice[i]-1]++;
-    bool has3 = false, has2 = false;
-    for (int i = 0; i < 6; ++i) {
-        if (arr[i] == 3) has3 = true;
-        if (arr[i] == 2) has2 = true;
-    }
-    return has3 && has2;
-}
+                    if (!slot_name.empty()) {
+                        // redraw commands section before drawing confirmation message
+                        clear_screen();
+                        draw_scorecard();
+                        draw_dice();
+                        screen << "Confirm submission of " << points << " points to " << slot_name << "?\n";
+                        screen << "[1] Yes   [0] No" << '\n';
+                        flush_output_buffer();
+                        char confirm = get_key();
+                        if (confirm == '1') {
+                            score_turn(turn, slot);
+                            valid = true;
+                        }
+                    }
+                    if (valid) { scored = true; break; }
+                }
+            }
+            if (scored) { turn_complete = true; break; }
+        } // end scoring phase
 
-bool is_small_straight() {
-    int arr[6] = {0};
-    int dice[5] = {d1, d2, d3, d4, d5};
-    for (int i = 0; i < 5; ++i) arr[dice[i]-1] = 1;
-    // check for 4 consecutive
-    for (int i = 0; i < 3; ++i) {
-        if (arr[i] && arr[i+1] && arr[i+2] && arr[i+3]) return true;
-    }
-    return false;
+    } // end while(!turn_complete)
+    return true;
 }
 
-bool is_large_straight() {
-    int arr[6] = {0};
-    int dice[5] = {d1, d2, d3, d4, d5};
-    for (int i = 0; i < 5; ++i) arr[dice[i]-1] = 1;
-    // check for 5 consecutive
-    if (arr[0] && arr[1] && arr[2] && arr[3] && arr[4]) return true;
-    if (arr[1] && arr[2] && arr[3] && arr[4] && arr[5]) return true;
-    return false;
+void show_cursor() {
+    cout << SHOW_CURSOR;
 }
 
-bool is_yahtzee() {
-    return (d1 == d2 && d2 == d3 && d3 == d4 && d4 == d5);
+void hide_cursor() {
+    cout << HIDE_CURSOR;
 }
 
-// Resets dice, holds and rolls for a new turn
-void reset_dice_and_holds() {
-    d1 = d2 = d3 = d4 = d5 = 0;
-    d1h = d2h = d3h = d4h = d5h = false;
-    rolls = 3;
-}
+int main(int argc, char* argv[]) {
+    const char* build_table = nullptr;
+    const char* build_distribution = nullptr;
+    const char* build_compact = nullptr;
+    uint64_t simulate = 0;
+    string strategy_name, tournament, variant = ClassicYahtzee::NAME;
+    uint64_t tournament_games = 100000;
+    int threads = 0;
+    uint64_t seed = (uint64_t(rd()) << 32) | rd();
+    const char* record_path = nullptr; // by default each game is logged under DEFAULT_REPLAY_DIR
+    bool new_game = false;
+    vector<const char*> replays;
+    bool fast = false;
+    bool serve = false;
+    string players;
+    const char* serve_socket = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--build-solver-table") {
+            build_table = has_value && argv[i + 1][0] != '-' ? argv[++i] : DEFAULT_SOLVER_TABLE;
+        } else if (arg == "--build-distribution-table") {
+            build_distribution = has_value && argv[i + 1][0] != '-' ? argv[++i] : DEFAULT_DISTRIBUTION_TABLE;
+        } else if (arg == "--build-compact-table") {
+            build_compact = has_value && argv[i + 1][0] != '-' ? argv[++i] : DEFAULT_COMPACT_TABLE;
+        } else if (arg == "--simulate" && has_value) {
+            simulate = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--variant" && has_value) {
+            variant = argv[++i];
+        } else if (arg == "--players" && has_value) {
+            players = argv[++i];
+        } else if (arg == "--strategy" && has_value) {
+            strategy_name = argv[++i];
+        } else if (arg == "--tournament" && has_value) {
+            tournament = argv[++i];
+        } else if (arg == "--games" && has_value) {
+            tournament_games = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && has_value) {
+            threads = atoi(argv[++i]);
+        } else if (arg == "--seed" && has_value) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--record" && has_value) {
+            record_path = argv[++i];
+        } else if (arg == "--slot" && has_value) {
+            save_slot = uint32_t(strtoul(argv[++i], nullptr, 10));
+            if (save_slot >= MAX_SAVE_SLOTS) {
+                cerr << "--slot takes 0 to " << MAX_SAVE_SLOTS - 1 << endl;
+                return 1;
+            }
+        } else if (arg == "--new-game") {
+            new_game = true;
+        } else if (arg == "--replay" && has_value) {
+            while (i + 1 < argc && argv[i + 1][0] != '-') replays.push_back(argv[++i]);
+        } else if (arg == "--latency-log" && has_value) {
+            latency_enable(argv[++i]);
+        } else if (arg == "--serve") {
+            serve = true;
+            if (has_value && argv[i + 1][0] != '-') serve_socket = argv[++i];
+        } else if (arg == "--fast") {
+            fast = true;
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            return 1;
+        }
+    }
+    if (build_table) {
+        cout << "Solving every scorecard state..." << endl;
+        if (!build_solver_table(build_table, threads)) {
+            cerr << "Could not write " << build_table << endl;
+            return 1;
+        }
+        cout << "Wrote " << build_table << endl;
+        return 0;
+    }
+    if (serve) return run_server(serve_socket, seed);
+    if (fast) {
+        // headless: recompute the final score of every log as fast as they can be read
+        auto start = chrono::steady_clock::now();
+        Replay replay;
+        GameState g;
+        int bad = 0;
+        for (const char* path : replays) {
+            if (!read_replay(path, replay)) {
+                cout << path << ": not a replay log" << '\n';
+                bad++;
+                continue;
+            }
+            const size_t applied = replay_game(replay, g);
+            cout << path << ": " << grand_total(g);
+            if (applied < replay.events.size()) { cout << " (stopped at illegal move " << applied + 1 << ")"; bad++; }
+            else if (!game_over(g)) cout << " (unfinished)";
+            cout << '\n';
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cerr << replays.size() << " logs in " << ms << " ms" << endl;
+        return bad ? 1 : 0;
+    }
+    // optional: without it the optimal EV is just not shown (the compact table does as well)
+    if (!load_solver_table()) load_solver_table(DEFAULT_COMPACT_TABLE);
+    if (build_compact) {
+        if (!solver_table().flat) {
+            cerr << "The compact table is made from the full solver table (--build-solver-table)" << endl;
+            return 1;
+        }
+        cout << "Checking every decision of the compact table..." << endl;
+        if (!build_compact_table(build_compact, threads)) {
+            cerr << "Could not write " << build_compact << endl;
+            return 1;
+        }
+        cout << "Wrote " << build_compact << endl;
+        return 0;
+    }
+    if (build_distribution) {
+        if (!solver_loaded()) {
+            cerr << "The score distributions need the solver table (--build-solver-table)" << endl;
+            return 1;
+        }
+        cout << "Solving score distributions..." << endl;
+        if (!build_distribution_table(build_distribution, threads)) {
+            cerr << "Could not write " << build_distribution << endl;
+            return 1;
+        }
+        cout << "Wrote " << build_distribution << endl;
+        return 0;
+    }
+    load_distribution_table(); // optional too: the chance of 250+ on the scorecard
+    if (simulate && variant != ClassicYahtzee::NAME) {
+        // other rule variants are simulated greedily (the solver only knows the classic game)
+        SimulationResult result;
+        if (!simulate_variant(variant.c_str(), simulate, threads, seed, result)) {
+            cerr << "Unknown variant: " << variant << " (yahtzee, " << Yatzy::NAME << " or " << MaxiYatzy::NAME << ")" << endl;
+            return 1;
+        }
+        cout << "seed: " << seed << endl << "variant: " << variant << endl << "strategy: greedy" << endl;
+        print_simulation(result, cout);
+        return 0;
+    }
+    if (simulate) {
+        if (strategy_name.empty()) strategy_name = solver_loaded() ? "optimal" : "greedy";
+        unique_ptr<Strategy> strategy = make_strategy(strategy_name.c_str());
+        if (!strategy) {
+            cerr << "Unknown strategy (or no solver table): " << strategy_name << endl;
+            return 1;
+        }
+        cout << "seed: " << seed << endl << "strategy: " << strategy->name() << endl;
+        print_simulation(simulate_games(simulate, threads, seed, *strategy), cout);
+        return 0;
+    }
+    if (!tournament.empty()) {
+        // comma-separated strategy names
+        vector<unique_ptr<Strategy>> entrants;
+        vector<const Strategy*> players;
+        for (size_t start = 0; start <= tournament.size(); ) {
+            size_t end = tournament.find(',', start);
+            if (end == string::npos) end = tournament.size();
+            const string name = tournament.substr(start, end - start);
+            entrants.push_back(make_strategy(name.c_str()));
+            if (!entrants.back()) {
+                cerr << "Unknown strategy (or no solver table): " << name << endl;
+                return 1;
+            }
+            players.push_back(entrants.back().get());
+            start = end + 1;
+        }
+        cout << "seed: " << seed << endl;
+        print_tournament(run_tournament(players, tournament_games, threads, seed), cout);
+        return 0;
+    }
 
-int main() {
-    enable_vt(); // try VT; if it fails we'll use the Win32 fallback helpers
+    if (!replays.empty()) {
+        Replay replay;
+        if (!read_replay(replays[0], replay)) {
+            cerr << "Could not read replay " << replays[0] << endl;
+            return 1;
+        }
+        show_replay(replay);
+        return 0;
+    }
 
-    CONSOLE_SCREEN_BUFFER_INFO csbi;
-    GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi);
-    int cols = csbi.srWindow.Right - csbi.srWindow.Left + 1;
-    int rows = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+    // one seat per --players entry (computer opponents by level), or just you
+    vector<unique_ptr<Strategy>> opponents;
+    for (size_t start = 0; start < players.size(); ) {
+        size_t end = players.find(',', start);
+        if (end == string::npos) end = players.size();
+        Seat seat;
+        seat.name = players.substr(start, end - start);
+        for (const AiLevel& level : AI_LEVELS) {
+            if (seat.name != level.name) continue;
+            opponents.push_back(make_strategy(level.strategy));
+            if (!opponents.back()) {
+                cerr << "The " << level.name << " opponent needs the solver table (--build-solver-table)" << endl;
+                return 1;
+            }
+            seat.ai = opponents.back().get();
+            seat.name = level.tag + to_string(seats.size() + 1);
+        }
+        seats.push_back(seat);
+        start = end + 1;
+    }
+    if (!players.empty() && (seats.size() < 2 || int(seats.size()) > MAX_SEATS)) {
+        cerr << "--players takes 2 to " << MAX_SEATS << " seats" << endl;
+        return 1;
+    }
+    const bool single_player = seats.empty();
+    if (single_player) seats.push_back(Seat{ "You", GameState(), nullptr });
+    const bool watched = std::any_of(seats.begin(), seats.end(), [](const Seat& s) { return !s.ai; });
+
+    // a game left in the save slot is picked up where it was (hot-seat games aren't saved)
+    bool resumed = false;
+    int first_turn = 0;
+    if (single_player) {
+        if (!saves.open()) cerr << "Could not open " << DEFAULT_SAVE_FILE << " (game not saved)" << endl;
+        saved = saves.load(save_slot);
+        resumed = saved.in_progress && !new_game;
+        if (resumed) {
+            seed = saved.seed;
+        } else {
+            saved.seed = seed;
+            saved.started = uint64_t(time(nullptr));
+        }
+    }
+    rng = Rng(seed);
+    if (resumed) {
+        rng.state = saved.rng_state;
+        dice.restore_buffer(saved.dice_digits, saved.dice_left);
+        seats[0].game = game = checkpoint_game(saved);
+        first_turn = saved.turn;
+    }
+    StatsStore stats;
+    if (single_player) {
+        // the replay log and the statistics are of your own games
+        string log_path = record_path ? record_path : replay_log_path(DEFAULT_REPLAY_DIR, seed, saved.started, save_slot);
+        if (!record_path) make_directory(DEFAULT_REPLAY_DIR);
+        if (resumed) {
+            if (!recorder.resume(log_path.c_str(), seed, saved.replay_events))
+                cerr << "Could not pick up " << log_path << " (rest of the game not recorded)" << endl;
+        } else if (!recorder.open(log_path.c_str(), seed)) {
+            cerr << "Could not write " << log_path << " (game not recorded)" << endl;
+        }
+        if (!stats.open()) cerr << "Could not open " << DEFAULT_STATS_LOG << " (game statistics not kept)" << endl;
+        if (!resumed) save_game(0, seats[0].game); // the new game takes the slot over at once
+    }
+
+    enable_vt(); // try VT; if it fails we'll use the legacy console fallback helpers
+    clr_screen(); // from here on frames only repaint the cells that changed
+    screen.terminal_cleared();
 
     // prevent starting screen from being drawn twice
     // clear_screen();
@@ -390,205 +684,67 @@ int main() {
     // draw_commands_before_first_roll();
     // flush_output_buffer();
 
-    char cmd = ' ';
-    bool can_roll = true;
-
-    for (int turn = 0; turn < 13; ++turn) {
-        bool turn_complete = false;
-        reset_dice_and_holds();
-
-        while (!turn_complete) {
-            // ROLLING PHASE
-            bool submitted = false;
-            can_roll = true;
-            while (can_roll && !submitted) {
-                clear_screen();
-                draw_scorecard();
-                draw_dice();
-                if (rolls == 3) draw_commands_before_first_roll();
-                else draw_commands_after_dice_roll();
-                flush_output_buffer();
-
-                cmd = _getch();
-                if (cmd == ' ' && rolls > 0) {
-                    animate_dice_roll();
-                    if (!d1h) { d1 = std::uniform_int_distribution<int>(1, 6)(rng); }
-                    if (!d2h) { d2 = std::uniform_int_distribution<int>(1, 6)(rng); }
-                    if (!d3h) { d3 = std::uniform_int_distribution<int>(1, 6)(rng); }
-                    if (!d4h) { d4 = std::uniform_int_distribution<int>(1, 6)(rng); }
-                    if (!d5h) { d5 = std::uniform_int_distribution<int>(1, 6)(rng); }
-                    rolls--;
-                    if (rolls == 0) can_roll = false;
-                } else if (cmd >= '1' && cmd <= '5' && rolls < 3) {
-                    int die_index = cmd - '1';
-                    switch (die_index) {
-                        case 0: d1h = !d1h; break;
-                        case 1: d2h = !d2h; break;
-                        case 2: d3h = !d3h; break;
-                        case 3: d4h = !d4h; break;
-                        case 4: d5h = !d5h; break;
-                    }
-                } else if (cmd == '0' && rolls < 3) {
-                    // replace with break for bugfix
-                    break;
-                } else if (cmd == 27 || cmd == 3) {
-                    return 0;
+    for (int turn = first_turn; turn < 13; ++turn) {
+        for (seat_to_move = 0; seat_to_move < int(seats.size()); ++seat_to_move) {
+            Seat& seat = seats[seat_to_move];
+            game = seat.game;
+            const bool played = seat.ai ? play_ai_turn(*seat.ai, watched) : play_human_turn(turn, stats, resumed);
+            resumed = false;
+            if (!played) {
+                if (saves.is_open()) {
+                    screen << at(29, 1) << "Game saved. Run CL_Yahtzee again to pick it up." << '\n';
+                    flush_output_buffer();
                 }
+                return 0;
             }
+            seat.game = game;
+        }
+    }
 
-            // SCORING PHASE
-            while (true) {
-                clear_screen();
-                draw_scorecard();
-                draw_dice();
-                draw_commands_select_section(rolls);
-                flush_output_buffer();
-                cmd = _getch();
-
-                if (cmd == 27 || cmd == 3) return 0;
-                if (cmd == '0' && rolls > 0) break; // Go back to dice rolling with same dice/rolls (if rolls greater than 0)
-
-                bool scored = false;
-                if (cmd == '1') {
-                    // UPPER SECTION SELECTION
-                    while (true) {
-                        clear_screen();
-                        draw_scorecard();
-                        draw_dice();
-                        draw_commands_select_upper_section();
-                        flush_output_buffer();
-                        cmd = _getch();
-                        bool valid = false;
-                        int points = 0;
-                        string slot_name;
-                        switch (cmd) {
-                            case '1':
-                                if (!ones_final)   { points = 1 * count_dice_with_value(1); slot_name = "1s"; }
-                                break;
-                            case '2':
-                                if (!twos_final)   { points = 2 * count_dice_with_value(2); slot_name = "2s"; }
-                                break;
-                            case '3':
-                                if (!threes_final) { points = 3 * count_dice_with_value(3); slot_name = "3s"; }
-                                break;
-                            case '4':
-                                if (!fours_final)  { points = 4 * count_dice_with_value(4); slot_name = "4s"; }
-                                break;
-                            case '5':
-                                if (!fives_final)  { points = 5 * count_dice_with_value(5); slot_name = "5s"; }
-                                break;
-                            case '6':
-                                if (!sixes_final)  { points = 6 * count_dice_with_value(6); slot_name = "6s"; }
-                                break;
-                            case '0':
-                                break;
-                            case 27: case 3:
-                                return 0;
-                        }
-                        if (cmd == '0') break;
-
-                        if (!slot_name.empty()) {
-                            // redraw commands section before drawing confirmation message
-                            clear_screen();
-                            draw_scorecard();
-                            draw_dice();
-                            cout << "Confirm submission of " << points << " points to " << slot_name << "?\n";
-                            cout << "[1] Yes   [0] No" << endl;
-                            flush_output_buffer();
-                            char confirm = _getch();
-                            cout << confirm << endl;
-                            if (confirm == '1') {
-                                switch (cmd) {
-                                    case '1': ones = points; ones_final = true; break;
-                                    case '2': twos = points; twos_final = true; break;
-                                    case '3': threes = points; threes_final = true; break;
-                                    case '4': fours = points; fours_final = true; break;
-                                    case '5': fives = points; fives_final = true; break;
-                                    case '6': sixes = points; sixes_final = true; break;
-                                }
-                                valid = true;
-                            }
-                        }
-                        if (valid) { scored = true; break; }
-                    }
-                } else if (cmd == '2') {
-                    // LOWER SECTION SELECTION
-                    while (true) {
-                        clear_screen();
-                        draw_scorecard();
-                        draw_dice();
-                        draw_commands_select_lower_section();
-                        flush_output_buffer();
-                        cmd = _getch();
-                        bool valid = false;
-                        int points = 0;
-                        string slot_name;
-                        switch (cmd) {
-                            case '1':
-                                if (!three_of_a_kind_final)   { points = potential_three_of_a_kind(); slot_name = "3 of a Kind"; }
-                                break;
-                            case '2':
-                                if (!four_of_a_kind_final)    { points = potential_four_of_a_kind(); slot_name = "4 of a Kind"; }
-                                break;
-                            case '3':
-                                if (!full_house_final)        { points = is_full_house() ? 25 : 0; slot_name = "Full House"; }
-                                break;
-                            case '4':
-                                if (!sml_straight_final)      { points = is_small_straight() ? 30 : 0; slot_name = "Small Straight"; }
-                                break;
-                            case '5':
-                                if (!lrg_straight_final)      { points = is_large_straight() ? 40 : 0; slot_name = "Large Straight"; }
-                                break;
-                            case '6':
-                                if (!yahtzee_final)           { points = is_yahtzee() ? 50 : 0; slot_name = "Yahtzee"; }
-                                break;
-                            case '7':
-                                if (!chance_final)            { points = d1 + d2 + d3 + d4 + d5; slot_name = "Chance"; }
-                                break;
-                            case '0':
-                                break;
-                            case 27: case 3:
-                                return 0;
-                        }
-                        if (cmd == '0') break;
-
-                        if (!slot_name.empty()) {
-                            // redraw commands section before drawing confirmation message
-                            clear_screen();
-                            draw_scorecard();
-                            draw_dice();
-                            cout << "Confirm submission of " << points << " points to " << slot_name << "?\n";
-                            cout << "[1] Yes   [0] No" << endl;
-                            flush_output_buffer();
-                            char confirm = _getch();
-                            cout << confirm << endl;
-                            if (confirm == '1') {
-                                switch (cmd) {
-                                    case '1': three_of_a_kind = points; three_of_a_kind_final = true; break;
-                                    case '2': four_of_a_kind = points; four_of_a_kind_final = true; break;
-                                    case '3': full_house = points; full_house_final = true; break;
-                                    case '4': sml_straight = points; sml_straight_final = true; break;
-                                    case '5': lrg_straight = points; lrg_straight_final = true; break;
-                                    case '6': yahtzee = points; yahtzee_final = true; break;
-                                    case '7': chance = points; chance_final = true; break;
-                                }
-                                valid = true;
-                            }
-                        }
-                        if (valid) { scored = true; break; }
-                    }
-                }
-                if (scored) { turn_complete = true; break; }
-            } // end scoring phase
-
-        } // end while(!turn_complete)
-    } // end for(turn)
+    if (!single_player) {
+        // final standings: ties share a place
+        seat_to_move = -1;
+        vector<int> order(seats.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = int(i);
+        std::stable_sort(order.begin(), order.end(),
+                         [](int a, int b) { return grand_total(seats[a].game) > grand_total(seats[b].game); });
+        clear_screen();
+        draw_scorecard();
+        screen << at(19, 1) << "Final standings:" << '\n';
+        for (size_t i = 0; i < order.size(); ++i) {
+            const int total = grand_total(seats[order[i]].game);
+            int place = 1;
+            for (const Seat& other : seats) place += grand_total(other.game) > total;
+            screen << at(20 + int(i), 1) << (place == 1 ? YELLOW : NORMAL) << place << ". "
+                   << seats[order[i]].name << ": " << total << NORMAL << '\n';
+        }
+        screen << at(29, 1) << "Game over! Press any key to exit..." << '\n';
+        flush_output_buffer();
+        get_key();
+        return 0;
+    }
 
+    // the game is over: nothing left in the slot to pick up. Cleared before the
+    // game is kept, so a crash in between can't resume it and keep it twice.
+    if (saves.is_open()) {
+        saved.in_progress = 0;
+        if (saves.save(save_slot, saved)) saves.sync();
+    }
+    // keep the finished game, then show where it stands among all of them
+    const bool kept = stats.is_open() && stats.append(make_game_record(game, seed, uint64_t(time(nullptr))));
     clear_screen();
     draw_scorecard();
-    cout << "Game over! Press any key to exit..." << endl;
-    _getch();
+    draw_dice();
+    if (kept) {
+        char line[64];
+        snprintf(line, sizeof(line), "This game beats %.0f%% of your games.", 100.0 * stats.fraction_below(grand_total(game)));
+        screen << at(23, 1) << line << '\n';
+        draw_stats(stats, 24);
+    }
+    screen << at(26, 1) << "Game over! Press any key to exit..." << '\n';
+    flush_output_buffer();
+    get_key();
 }
 
 // why did i make this
-// to build: g++ -O2 -static -static-libstdc++ -static-libgcc cl_yahtzee.cpp -o cl_yahtzee.exe -lwinpthread
\ No newline at end of file
+// to build: cmake -S . -B build && cmake --build build   (see README for a one-line MinGW build)
\ No newline at end of file
@@ -0,0 +1,380 @@
+// CL_Yahtzee compact solver table
+//
+// File: header, the byte offset of each block into the block data (and of the
+// end), the states stored exactly (state indices ascending, then their
+// values), then the blocks. A block is the rows (every upper subtotal of one
+// scorecard) of BLOCK_STATES / UPPER_STATES scorecards; a row stores only the
+// subtotals its filled upper categories can add up to (the rest read as 0):
+// the first value in 24 bits (at 4096 steps a point, values pass 16 bits),
+// a Rice parameter k in 4 bits, and the zigzagged difference to each next
+// value, Rice coded with k (the quotient in unary, 1s ended by a 0, then the
+// k low bits). Bits are packed low first, and each block starts on a byte of
+// its own.
+
+#include "compact_table.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char COMPACT_MAGIC[8] = { 'C', 'L', 'Y', 'Z', 'E', 'V', 'Q', '\0' };
+const uint32_t COMPACT_VERSION = 1;     // 1: from solver table version 2
+const float STEPS_PER_POINT = 4096.0f;
+const int NUM_BLOCKS = NUM_STATES / BLOCK_STATES;
+const int BLOCK_PADDING = 8;
+static_assert(NUM_STATES % BLOCK_STATES == 0 && BLOCK_STATES % UPPER_STATES == 0, "blocks are whole rows");
+
+struct CompactFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_states;
+    uint32_t num_exact;
+    uint32_t reserved;
+};
+
+struct BitWriter {
+    std::vector<uint8_t>& out;
+    uint64_t buf = 0;
+    int bits = 0;
+
+    void put(uint32_t value, int n) {
+        buf |= uint64_t(value) << bits;
+        bits += n;
+        while (bits >= 8) { out.push_back(uint8_t(buf)); buf >>= 8; bits -= 8; }
+    }
+    void put_unary(uint32_t n) {
+        for (; n >= 16; n -= 16) put(0xffff, 16);
+        put((1u << n) - 1, int(n) + 1);
+    }
+    void flush() {
+        if (bits) out.push_back(uint8_t(buf));
+        buf = 0;
+        bits = 0;
+    }
+};
+
+// Reads up to 8 bytes ahead of the bits it returns (the file ends in BLOCK_PADDING zeros).
+struct BitReader {
+    const uint8_t* p;
+    uint64_t buf = 0;
+    int bits = 0;
+
+    void refill() {
+        while (bits <= 56) { buf |= uint64_t(*p++) << bits; bits += 8; }
+    }
+    uint32_t get(int n) {
+        if (bits < n) refill();
+        const uint32_t value = uint32_t(buf & ((uint64_t(1) << n) - 1));
+        buf >>= n;
+        bits -= n;
+        return value;
+    }
+    uint32_t get_unary() {
+        uint32_t n = 0;
+        for (;;) {
+            refill();
+            // 1s up to the first 0 (the bits above the buffered ones read as 0)
+            const uint64_t zeros = ~buf;
+            const int ones = zeros ? lowest_bit(zeros) : 64;
+            if (ones < bits) {
+                buf = ones < 63 ? buf >> (ones + 1) : 0;
+                bits -= ones + 1;
+                return n + uint32_t(ones);
+            }
+            n += uint32_t(bits);
+            buf = 0;
+            bits = 0;
+        }
+    }
+};
+
+uint32_t zigzag(int v) { return v >= 0 ? uint32_t(v) << 1 : (uint32_t(-v) << 1) - 1; }
+int unzigzag(uint32_t z) { return (z & 1) ? -int((z + 1) >> 1) : int(z >> 1); }
+
+uint16_t row_filled(int row) { return state_at(row * UPPER_STATES).filled; }
+
+void encode_block(const std::vector<uint32_t>& q, int block, std::vector<uint8_t>& out) {
+    BitWriter bits{ out };
+    const int first_row = block * (BLOCK_STATES / UPPER_STATES);
+    for (int row = first_row; row < first_row + BLOCK_STATES / UPPER_STATES; ++row) {
+        const uint16_t filled = row_filled(row);
+        std::vector<int> values;
+        for (int up = 0; up < UPPER_STATES; ++up)
+            if (upper_reachable(filled, up)) values.push_back(q[row * UPPER_STATES + up]);
+        if (values.empty()) continue;
+
+        // the k that codes this row's differences in the fewest bits
+        int best_k = 0;
+        uint64_t best_bits = ~uint64_t(0);
+        for (int k = 0; k < 16; ++k) {
+            uint64_t n = 0;
+            for (size_t i = 1; i < values.size(); ++i) n += 1 + k + (zigzag(values[i] - values[i - 1]) >> k);
+            if (n < best_bits) { best_bits = n; best_k = k; }
+        }
+        bits.put(uint32_t(values[0]), 24);
+        bits.put(uint32_t(best_k), 4);
+        for (size_t i = 1; i < values.size(); ++i) {
+            const uint32_t z = zigzag(values[i] - values[i - 1]);
+            bits.put_unary(z >> best_k);
+            bits.put(z & ((1u << best_k) - 1), best_k);
+        }
+    }
+    bits.flush();
+}
+
+// Choices within this many points of each other are equally good: the full
+// table's own float rounding is about that size.
+const float SAME_VALUE = 1e-4f;
+
+// Everything a state decides: the category for each hand that ends the turn,
+// and the keep for each hand with one or two rolls left.
+struct Decisions {
+    uint8_t category[NUM_HANDS];
+    uint16_t keep[ROLLS_PER_TURN - 1][NUM_HANDS];
+};
+
+// The distinct keeps of each hand in the order best_hold tries them (holding
+// everything first), so the first best one is the keep best_hold picks.
+struct HoldOrder {
+    std::vector<uint16_t> keeps[NUM_HANDS];
+    HoldOrder() {
+        for (int h = 0; h < NUM_HANDS; ++h)
+            for (int mask = (1 << NUM_DICE) - 1; mask >= 0; --mask) {
+                const uint16_t k = uint16_t(keep_index(HAND_TABLES.dice[h], uint8_t(mask)));
+                if (std::find(keeps[h].begin(), keeps[h].end(), k) == keeps[h].end()) keeps[h].push_back(k);
+            }
+    }
+};
+
+void decide(const StateValues& ev, const SolverState& s, const HoldOrder& order, TurnValues& tv, Decisions& d) {
+    compute_turn_values(ev, s, tv);
+    for (int h = 0; h < NUM_HANDS; ++h) {
+        d.category[h] = uint8_t(best_category_for_hand(ev, s, h));
+        for (int r = 1; r < ROLLS_PER_TURN; ++r) {
+            const float* keep = tv.keep[r - 1];
+            uint16_t best = order.keeps[h][0];
+            for (uint16_t k : order.keeps[h])
+                if (keep[k] > keep[best]) best = k;
+            d.keep[r - 1][h] = best;
+        }
+    }
+}
+
+// Does got lose anything against want, valued with the full table (whose turn values are tv)?
+bool worse_decisions(const float* full, const SolverState& s, const TurnValues& tv, const Decisions& want, const Decisions& got) {
+    for (int h = 0; h < NUM_HANDS; ++h) {
+        const Category a = Category(want.category[h]), b = Category(got.category[h]);
+        if (a != b && score_value(full, s, a, hand_points(s.filled, h, a)) -
+                      score_value(full, s, b, hand_points(s.filled, h, b)) > SAME_VALUE) return true;
+        for (int r = 1; r < ROLLS_PER_TURN; ++r)
+            if (tv.keep[r - 1][want.keep[r - 1][h]] - tv.keep[r - 1][got.keep[r - 1][h]] > SAME_VALUE) return true;
+    }
+    return false;
+}
+
+// Every state a turn of s can end in (the values its decisions read).
+template <class Visit>
+void for_each_next_state(const SolverState& s, Visit visit) {
+    int bonus;
+    for (int c = 0; c < NUM_CATEGORIES; ++c) {
+        if ((s.filled >> c) & 1) continue;
+        if (c <= SIXES) {
+            for (int n = 0; n <= NUM_DICE; ++n) visit(state_index(next_state(s, Category(c), n * (c + 1), bonus)));
+        } else {
+            visit(state_index(next_state(s, Category(c), 0, bonus)));
+            if (c == YAHTZEE) visit(state_index(next_state(s, Category(c), 50, bonus)));
+        }
+    }
+}
+
+} // namespace
+
+class CompactTable {
+public:
+    const uint32_t* block_offset;       // NUM_BLOCKS + 1 of them
+    const uint32_t* exact_index;
+    const float* exact_value;
+    uint32_t num_exact;
+    const uint8_t* blocks;
+
+    void decode(int block, float* out) const {
+        BitReader bits{ blocks + block_offset[block] };
+        const int first = block * BLOCK_STATES;
+        for (int row = 0; row < BLOCK_STATES / UPPER_STATES; ++row) {
+            float* values = out + row * UPPER_STATES;
+            const uint16_t filled = row_filled(first / UPPER_STATES + row);
+            int q = -1, k = 0;
+            for (int up = 0; up < UPPER_STATES; ++up) {
+                if (!upper_reachable(filled, up)) { values[up] = 0.0f; continue; }
+                if (q < 0) {
+                    q = int(bits.get(24));
+                    k = int(bits.get(4));
+                } else {
+                    const uint32_t high = bits.get_unary();
+                    q += unzigzag((high << k) | bits.get(k));
+                }
+                values[up] = float(q) / STEPS_PER_POINT;
+            }
+        }
+        const uint32_t* end = exact_index + num_exact;
+        for (const uint32_t* e = std::lower_bound(exact_index, end, uint32_t(first));
+             e != end && *e < uint32_t(first + BLOCK_STATES); ++e)
+            out[*e - uint32_t(first)] = exact_value[e - exact_index];
+    }
+};
+
+float compact_value(const CompactTable& table, int index) {
+    // each thread's most recently used blocks, decoded
+    struct BlockCache {
+        const CompactTable* table[CACHED_BLOCKS] = {};
+        int block[CACHED_BLOCKS];
+        uint32_t last_use[CACHED_BLOCKS] = {};
+        uint32_t clock = 0;
+        float values[CACHED_BLOCKS][BLOCK_STATES];
+    };
+    thread_local std::unique_ptr<BlockCache> cache;
+    if (!cache) cache.reset(new BlockCache());
+    BlockCache& c = *cache;
+
+    const int block = index / BLOCK_STATES;
+    int slot = -1, oldest = 0;
+    for (int i = 0; i < CACHED_BLOCKS; ++i) {
+        if (c.table[i] == &table && c.block[i] == block) { slot = i; break; }
+        if (c.last_use[i] < c.last_use[oldest]) oldest = i;
+    }
+    if (slot < 0) {
+        slot = oldest;
+        table.decode(block, c.values[slot]);
+        c.table[slot] = &table;
+        c.block[slot] = block;
+    }
+    c.last_use[slot] = ++c.clock;
+    return c.values[slot][index % BLOCK_STATES];
+}
+
+bool build_compact_table(const char* path, int threads) {
+    const float* full = solver_table().flat;
+    if (!full) return false;
+    if (threads <= 0) threads = int(std::thread::hardware_concurrency());
+    if (threads <= 0) threads = 1;
+
+    std::vector<uint32_t> q(NUM_STATES);
+    std::vector<float> approx(NUM_STATES);
+    for (int i = 0; i < NUM_STATES; ++i) {
+        q[i] = uint32_t(std::min(0xffffffL, std::max(0L, std::lround(full[i] * STEPS_PER_POINT))));
+        approx[i] = float(q[i]) / STEPS_PER_POINT;
+    }
+
+    // Check the decisions of every state a game can reach against the full
+    // table. Where one differs, the states it reads are stored exactly; that
+    // changes what other states read, so those are checked again, until none
+    // differ.
+    std::vector<int> decision_states;
+    for (int i = 0; i < NUM_STATES; ++i) {
+        const SolverState s = state_at(i);
+        if (s.filled != ALL_CATEGORIES && upper_reachable(s.filled, s.up)) decision_states.push_back(i);
+    }
+    static const HoldOrder order;
+    std::vector<uint8_t> exact(NUM_STATES, 0);
+    std::vector<int> check = decision_states;
+    while (!check.empty()) {
+        std::vector<uint8_t> differs(check.size(), 0);
+        std::atomic<size_t> next(0);
+        auto work = [&] {
+            std::unique_ptr<TurnValues> tv(new TurnValues), approx_tv(new TurnValues);
+            std::unique_ptr<Decisions> want(new Decisions), got(new Decisions);
+            for (size_t i; (i = next.fetch_add(1)) < check.size(); ) {
+                const SolverState s = state_at(check[i]);
+                decide(full, s, order, *tv, *want);
+                decide(approx.data(), s, order, *approx_tv, *got);
+                differs[i] = std::memcmp(want.get(), got.get(), sizeof(Decisions)) != 0 &&
+                             worse_decisions(full, s, *tv, *want, *got);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int i = 1; i < threads; ++i) pool.emplace_back(work);
+        work();
+        for (std::thread& th : pool) th.join();
+
+        std::vector<uint8_t> row_changed(NUM_STATES / UPPER_STATES, 0);
+        bool changed = false;
+        for (size_t i = 0; i < check.size(); ++i) {
+            if (!differs[i]) continue;
+            for_each_next_state(state_at(check[i]), [&](int n) {
+                if (exact[n]) return;
+                exact[n] = 1;
+                approx[n] = full[n];
+                row_changed[n / UPPER_STATES] = 1;
+                changed = true;
+            });
+        }
+        check.clear();
+        if (!changed) break;
+        for (int i : decision_states) {
+            bool reads_changed = false;
+            for_each_next_state(state_at(i), [&](int n) { reads_changed |= row_changed[n / UPPER_STATES] != 0; });
+            if (reads_changed) check.push_back(i);
+        }
+    }
+
+    std::vector<uint32_t> offsets, exact_index;
+    std::vector<float> exact_value;
+    std::vector<uint8_t> data;
+    for (int b = 0; b < NUM_BLOCKS; ++b) {
+        offsets.push_back(uint32_t(data.size()));
+        encode_block(q, b, data);
+    }
+    offsets.push_back(uint32_t(data.size()));
+    data.resize(data.size() + BLOCK_PADDING, 0);
+    for (int i = 0; i < NUM_STATES; ++i)
+        if (exact[i]) { exact_index.push_back(uint32_t(i)); exact_value.push_back(full[i]); }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    CompactFileHeader header{};
+    std::memcpy(header.magic, COMPACT_MAGIC, sizeof(header.magic));
+    header.version = COMPACT_VERSION;
+    header.num_states = NUM_STATES;
+    header.num_exact = uint32_t(exact_index.size());
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(offsets.data(), sizeof(uint32_t), offsets.size(), f) == offsets.size() &&
+              fwrite(exact_index.data(), sizeof(uint32_t), exact_index.size(), f) == exact_index.size() &&
+              fwrite(exact_value.data(), sizeof(float), exact_value.size(), f) == exact_value.size() &&
+              fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = fclose(f) == 0 && ok;
+    return ok;
+}
+
+const CompactTable* open_compact_table(const char* path) {
+    size_t size = 0;
+    const void* data = map_file(path, size);
+    if (!data) return nullptr;
+    const CompactFileHeader* header = static_cast<const CompactFileHeader*>(data);
+    const size_t fixed = sizeof(CompactFileHeader) + sizeof(uint32_t) * (NUM_BLOCKS + 1);
+    if (size < fixed || std::memcmp(header->magic, COMPACT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != COMPACT_VERSION || header->num_states != NUM_STATES ||
+        size < fixed + size_t(header->num_exact) * (sizeof(uint32_t) + sizeof(float))) {
+        unmap_file(data, size);
+        return nullptr;
+    }
+    CompactTable* table = new CompactTable();
+    table->block_offset = reinterpret_cast<const uint32_t*>(header + 1);
+    table->exact_index = table->block_offset + NUM_BLOCKS + 1;
+    table->num_exact = header->num_exact;
+    table->exact_value = reinterpret_cast<const float*>(table->exact_index + table->num_exact);
+    table->blocks = reinterpret_cast<const uint8_t*>(table->exact_value + table->num_exact);
+    if (size != size_t(table->blocks - static_cast<const uint8_t*>(data)) + table->block_offset[NUM_BLOCKS] + BLOCK_PADDING) {
+        delete table;
+        unmap_file(data, size);
+        return nullptr;
+    }
+    return table;
+}
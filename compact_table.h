@@ -0,0 +1,27 @@
+// CL_Yahtzee compact solver table
+// The solver table for small installs: state values in fixed point (1/4096
+// point), Rice-coded in blocks of BLOCK_STATES states (about 1 MB against
+// 3 MB). Nothing is decoded on load; a block is decoded the first time one of
+// its states is read, and each thread keeps its most recently used blocks.
+//
+// Decisions are as good as with the full table: when it's built, every
+// category and hold choice of every state is checked against the full table,
+// and wherever rounding made one worse (by more than the full table's own
+// float rounding), the states that choice depends on are stored exactly.
+
+#pragma once
+
+#include "solver.h"
+
+const char* const DEFAULT_COMPACT_TABLE = "cl_yahtzee.evz";
+
+const int BLOCK_STATES = 1024;          // 16 scorecards x every upper subtotal
+const int CACHED_BLOCKS = 32;           // decoded blocks kept per thread
+
+// Writes the compact form of the loaded (full) solver table to path, checking
+// its decisions on threads threads (<= 0 uses all cores).
+bool build_compact_table(const char* path, int threads = 0);
+
+// Memory-maps a table written by build_compact_table. Returns null if missing
+// or invalid. The table stays mapped for the rest of the run.
+const CompactTable* open_compact_table(const char* path);
@@ -0,0 +1,300 @@
+// CL_Yahtzee final score distributions
+//
+// For every state the table holds the survival function S(x) = P(points
+// still to come >= x). A state's S is the mix, over the hands the turn can
+// end on (final_hand_odds) and the category optimal play scores them in, of
+// the next state's S shifted by the points scored. Layers are solved from the
+// full scorecard backwards, like the solver.
+
+#include "distribution.h"
+#include "mapped_file.h"
+#include "solver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+const char DIST_MAGIC[8] = { 'C', 'L', 'Y', 'Z', 'D', 'S', '\0', '\0' };
+const uint32_t DIST_VERSION = 2;       // 2: Yahtzee bonus and Joker rules
+const uint32_t NO_RECORD = 0xffffffffu;
+const int LEVELS = 255;     // S is stored in 1/255ths: plenty for a percentage
+const int RUN = 14;          // nibble codes: steps 0..13, RUN, ESCAPE
+const int ESCAPE = 15;
+
+// File: header, one record offset per state (in bytes into the records,
+// NO_RECORD if unreachable), then the records. A record is lo (16 bits; S is
+// 1 below it) and then the steps down from 255 at lo, lo + 1, ... in nibbles,
+// low nibble first: a step below RUN as is, RUN and two nibbles for that many
+// steps of 0 (the flat stretches between Yahtzee bonuses), ESCAPE and two
+// nibbles for a bigger step. The record ends when the level reaches 0.
+struct DistFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_states;
+    uint32_t record_bytes;
+    uint32_t reserved;
+};
+
+const uint32_t* g_offsets = nullptr;
+const uint8_t* g_records = nullptr;
+
+void encode_record(int lo, const std::vector<int>& levels, std::vector<uint8_t>& out) {
+    out.clear();
+    out.push_back(uint8_t(lo));
+    out.push_back(uint8_t(lo >> 8));
+    std::vector<uint8_t> nibbles;
+    int prev = LEVELS;
+    for (size_t i = 0; i <= levels.size(); ++i) {
+        const int level = i < levels.size() ? levels[i] : 0;
+        const int step = prev - level;
+        prev = level;
+        size_t run = 0;
+        while (step == 0 && i + run < levels.size() && levels[i + run] == level && run < 255) ++run;
+        if (run >= 3) {
+            nibbles.push_back(RUN);
+            nibbles.push_back(uint8_t(run & 15));
+            nibbles.push_back(uint8_t(run >> 4));
+            i += run - 1;
+        } else if (step < RUN) {
+            nibbles.push_back(uint8_t(step));
+        } else {
+            nibbles.push_back(ESCAPE);
+            nibbles.push_back(uint8_t(step & 15));
+            nibbles.push_back(uint8_t(step >> 4));
+        }
+    }
+    for (size_t i = 0; i < nibbles.size(); i += 2)
+        out.push_back(uint8_t(nibbles[i] | (i + 1 < nibbles.size() ? nibbles[i + 1] << 4 : 0)));
+}
+
+// Most the open upper categories can still add.
+int upper_left(uint16_t filled) {
+    int left = 0;
+    for (int c = ONES; c <= SIXES; ++c)
+        if (!((filled >> c) & 1)) left += NUM_DICE * (c + 1);
+    return left;
+}
+
+// The state as far as the future goes: once the upper bonus is won or out of
+// reach the subtotal no longer matters, and all those states share UPPER_BONUS_THRESHOLD.
+SolverState future_state(SolverState s) {
+    if (s.up + upper_left(s.filled) < UPPER_BONUS_THRESHOLD) s.up = UPPER_BONUS_THRESHOLD;
+    return s;
+}
+
+// Survival function in floats while building: 1 below lo, s[i] at lo + i, 0 past the end.
+struct Survival {
+    int lo = 0;
+    std::vector<float> s;
+};
+
+void solve_state(const StateValues& ev, const SolverState& state, const std::vector<Survival>& table, TurnValues& tv, Survival& out) {
+    compute_turn_values(ev, state, tv);
+    float odds[NUM_HANDS];
+    final_hand_odds(tv, -1, 0, odds);
+
+    // group the end-of-turn outcomes by where they lead and how far they shift
+    const int MAX_POINTS = 50;
+    static thread_local float weight[2][NUM_CATEGORIES][MAX_POINTS + 1]; // [Yahtzee bonus?]
+    std::memset(weight, 0, sizeof(weight));
+    for (int h = 0; h < NUM_HANDS; ++h) {
+        if (odds[h] == 0.0f) continue;
+        const Category c = best_category_for_hand(ev, state, h);
+        weight[hand_bonus(state, h) != 0][c][hand_points(state.filled, h, c)] += odds[h];
+    }
+
+    const int length = MAX_SCORE + 1;
+    static thread_local std::vector<float> mix;
+    mix.assign(length, 0.0f);
+    float ones = 0.0f; // weight that is certain at x = 0
+    for (int yahtzee = 0; yahtzee < 2; ++yahtzee)
+    for (int c = 0; c < NUM_CATEGORIES; ++c) {
+        for (int points = 0; points <= MAX_POINTS; ++points) {
+            const float w = weight[yahtzee][c][points];
+            if (w == 0.0f) continue;
+            int bonus;
+            const SolverState next = next_state(state, Category(c), points, bonus);
+            const Survival& child = table[state_index(future_state(next))];
+            const int shift = points + bonus + yahtzee * YAHTZEE_BONUS;
+            // S(x) = child S(x - shift): 1 up to shift + child.lo, then the child's values
+            ones += w;
+            const int first = std::min(length, shift + child.lo);
+            for (int x = 1; x < first; ++x) mix[x] += w;
+            const float* s = child.s.data();
+            const int end = std::min<int>(length, first + int(child.s.size()));
+            for (int x = first; x < end; ++x) mix[x] += w * s[x - first];
+        }
+    }
+    mix[0] = ones;
+
+    // trim the certain head and the negligible tail (long Yahtzee bonus streaks)
+    int lo = 0, hi = length;
+    while (lo < length && mix[lo] >= 1.0f - 1e-9f) ++lo;
+    while (hi > lo && mix[hi - 1] < 1e-8f) --hi;
+    out.lo = lo;
+    out.s.assign(mix.begin() + lo, mix.begin() + hi);
+}
+
+} // namespace
+
+bool build_distribution_table(const char* path, int threads) {
+    const StateValues& ev = solver_table();
+    if (!ev) return false;
+    if (threads <= 0) threads = int(std::thread::hardware_concurrency());
+    if (threads <= 0) threads = 1;
+
+    // every state with a future of its own, indexed like the solver table
+    std::vector<Survival> table(NUM_STATES);
+    for (int flag = 0; flag < 2; ++flag) { // no points left: S = 1 at 0 only
+        SolverState end;
+        end.filled = ALL_CATEGORIES;
+        end.up = UPPER_BONUS_THRESHOLD;
+        end.yahtzee50 = flag != 0;
+        table[state_index(end)].lo = 1;
+    }
+
+    for (int layer = NUM_CATEGORIES - 1; layer >= 0; --layer) {
+        // one reachable state per distinct future (the solver skips unreachable ones)
+        std::vector<SolverState> states;
+        for (int m = 0; m < (1 << NUM_CATEGORIES); ++m) {
+            if (popcount(m) != layer) continue;
+            for (int flag = 0; flag <= ((m >> YAHTZEE) & 1); ++flag) {
+                bool settled = false;
+                SolverState s;
+                s.filled = uint16_t(m);
+                s.yahtzee50 = flag != 0;
+                for (s.up = 0; s.up < UPPER_STATES; ++s.up) {
+                    if (!upper_reachable(s.filled, s.up)) continue;
+                    const bool shared = future_state(s).up == UPPER_BONUS_THRESHOLD;
+                    if (!shared || !settled) states.push_back(s);
+                    settled |= shared;
+                }
+            }
+        }
+        std::atomic<size_t> next(0);
+        auto work = [&] {
+            TurnValues* tv = new TurnValues;
+            for (size_t i; (i = next.fetch_add(1)) < states.size(); )
+                solve_state(ev, states[i], table, *tv, table[state_index(future_state(states[i]))]);
+            delete tv;
+        };
+        std::vector<std::thread> pool;
+        for (int i = 1; i < threads; ++i) pool.emplace_back(work);
+        work();
+        for (std::thread& th : pool) th.join();
+    }
+
+    // quantize, and store each distinct record once
+    std::vector<uint32_t> offsets(NUM_STATES, NO_RECORD);
+    std::vector<uint8_t> records, rec;
+    std::unordered_map<std::string, uint32_t> seen;
+    std::vector<int> levels;
+    for (int state = 0; state < NUM_STATES; ++state) {
+        const SolverState at = state_at(state);
+        if (!upper_reachable(at.filled, at.up)) continue;
+        const Survival& s = table[state_index(future_state(at))];
+        levels.clear();
+        for (float v : s.s) levels.push_back(int(std::lround(v * LEVELS)));
+        size_t head = 0;
+        while (head < levels.size() && levels[head] == LEVELS) ++head;
+        while (!levels.empty() && levels.back() == 0) levels.pop_back();
+        const int lo = s.lo + int(head);
+        levels.erase(levels.begin(), levels.begin() + std::min(head, levels.size()));
+        encode_record(lo, levels, rec);
+        const std::string key(rec.begin(), rec.end());
+        auto it = seen.find(key);
+        if (it == seen.end()) {
+            it = seen.emplace(key, uint32_t(records.size())).first;
+            records.insert(records.end(), rec.begin(), rec.end());
+        }
+        offsets[state] = it->second;
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    DistFileHeader header;
+    std::memcpy(header.magic, DIST_MAGIC, sizeof(header.magic));
+    header.version = DIST_VERSION;
+    header.num_states = NUM_STATES;
+    header.record_bytes = uint32_t(records.size());
+    header.reserved = 0;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(offsets.data(), sizeof(uint32_t), offsets.size(), f) == offsets.size() &&
+              fwrite(records.data(), 1, records.size(), f) == records.size();
+    ok = fclose(f) == 0 && ok;
+    return ok;
+}
+
+bool load_distribution_table(const char* path) {
+    size_t size = 0;
+    const void* data = map_file(path, size);
+    if (!data) return false;
+    const DistFileHeader* header = static_cast<const DistFileHeader*>(data);
+    if (size < sizeof(DistFileHeader) || std::memcmp(header->magic, DIST_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != DIST_VERSION || header->num_states != NUM_STATES ||
+        size != sizeof(DistFileHeader) + sizeof(uint32_t) * NUM_STATES + size_t(header->record_bytes)) {
+        unmap_file(data, size);
+        return false;
+    }
+    g_offsets = reinterpret_cast<const uint32_t*>(header + 1);
+    g_records = reinterpret_cast<const uint8_t*>(g_offsets + NUM_STATES);
+    return true;
+}
+
+bool distribution_loaded() { return g_offsets != nullptr; }
+
+float chance_future_at_least(const SolverState& s, int points) {
+    if (points <= 0) return 1.0f;
+    if (!g_offsets) return 0.0f;
+    const uint32_t offset = g_offsets[state_index(s)];
+    if (offset == NO_RECORD) return 0.0f;
+    const uint8_t* rec = g_records + offset;
+    const int lo = rec[0] | rec[1] << 8;
+    if (points < lo) return 1.0f;
+    // walk the steps from lo up to points
+    const uint8_t* bytes = rec + 2;
+    size_t nibble = 0;
+    auto next = [&] { const int v = (bytes[nibble / 2] >> (nibble % 2 * 4)) & 15; ++nibble; return v; };
+    int level = LEVELS;
+    for (int x = lo; x <= points && level > 0; ++x) {
+        int step = next();
+        if (step == RUN) {
+            step = next();
+            x += (step | next() << 4) - 1;
+            continue;
+        }
+        if (step == ESCAPE) { step = next(); step |= next() << 4; }
+        level -= step;
+    }
+    return float(level) * (1.0f / LEVELS);
+}
+
+float chance_at_least(const GameState& g, int target) {
+    const int need = target - grand_total(g);
+    if (need <= 0) return 1.0f;
+    if (!g_offsets || !solver_loaded() || game_over(g)) return 0.0f;
+    const SolverState s = solver_state(g);
+    if (!has_rolled(g)) return chance_future_at_least(s, need);
+
+    // mid-turn: where the rest of this turn can end, each scored optimally
+    float odds[NUM_HANDS];
+    final_hand_odds(cached_turn_values(s), g.hand, g.rolls, odds);
+    float chance = 0.0f;
+    for (int h = 0; h < NUM_HANDS; ++h) {
+        if (odds[h] == 0.0f) continue;
+        const Category c = best_category_for_hand(solver_table(), s, h);
+        const int points = hand_points(s.filled, h, c);
+        int bonus;
+        const SolverState next = next_state(s, c, points, bonus);
+        chance += odds[h] * chance_future_at_least(next, need - points - bonus - hand_bonus(s, h));
+    }
+    return chance;
+}
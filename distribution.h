@@ -0,0 +1,28 @@
+// CL_Yahtzee final score distributions
+// P(final score >= X) under optimal play, from any state. Built from the
+// solver table by pushing whole score distributions back through the turns;
+// states whose futures are the same (the upper bonus is settled or out of
+// reach) share one record, and the shipped table stores each
+// one in 1/255ths as nibble-coded steps (about 26 MB).
+
+#pragma once
+
+#include "solver.h"
+
+const char* const DEFAULT_DISTRIBUTION_TABLE = "cl_yahtzee.dist";
+
+// Builds the table for the loaded solver table and writes it to path.
+// threads <= 0 uses all cores.
+bool build_distribution_table(const char* path, int threads = 0);
+
+// Memory-maps a table written by build_distribution_table. Returns false if
+// missing or invalid.
+bool load_distribution_table(const char* path = DEFAULT_DISTRIBUTION_TABLE);
+bool distribution_loaded();
+
+// P(points still to come from the start of a turn in s >= points).
+float chance_future_at_least(const SolverState& s, int points);
+
+// P(g's final score >= target) with optimal play from here on, including any
+// turn in progress. Needs the solver and distribution tables.
+float chance_at_least(const GameState& g, int target);
@@ -0,0 +1,252 @@
+// CL_Yahtzee screen layout
+
+#include "draw.h"
+#include "solver.h"
+#include "distribution.h"
+#include "stats.h"
+#include "latency.h"
+
+#include <cstdio>
+
+// the score the scorecard gives the odds of reaching (needs the distribution table)
+const int TARGET_SCORE = 250;
+
+// scorecard, dice, holds and rolls for the current game
+GameState game;
+
+const char* const CATEGORY_NAMES[NUM_CATEGORIES] = {
+    "1s", "2s", "3s", "4s", "5s", "6s",
+    "3 of a Kind", "4 of a Kind", "Full House", "Small Straight", "Large Straight", "Yahtzee", "Chance"
+};
+
+// players in a hot-seat game (see draw.h)
+std::vector<Seat> seats;
+int seat_to_move = 0;
+
+// frames are drawn off-screen and only the cells that changed are written out
+Screen screen;
+
+void clear_screen() {
+    latency_draw_start();
+    screen.clear();
+}
+
+// finalization helper functions
+bool all_upper_final() {
+    return (game.filled & UPPER_MASK) == UPPER_MASK;
+}
+bool all_lower_final() {
+    return (game.filled & ~UPPER_MASK & ALL_CATEGORIES) == (ALL_CATEGORIES & ~UPPER_MASK);
+}
+
+// optimal expected final score from here on (needs the solver table)
+double expected_final_score() {
+    const SolverState s = solver_state(game);
+    if (!has_rolled(game)) return grand_total(game) + state_ev(s);
+    const TurnValues& tv = cached_turn_values(s);
+    return grand_total(game) + tv.hand[game.rolls][game.hand];
+}
+
+// prints a slot's score, followed by what the current dice would score there if it's still open
+void draw_slot(Category c) {
+    screen << (is_filled(game, c) ? YELLOW : NORMAL) << int(game.score[c]) << NORMAL;
+    if ((legal_categories(game) >> c) & 1) screen << "\b(" << potential_score(game, c) << ")"; // applied backspace chars
+    screen << '\n';
+}
+
+void draw_scorecard() {
+    if (seats.size() > 1) {
+        draw_scoreboard();
+        return;
+    }
+    screen << at(1, 1) << "CL_Yahtzee v1.0 | Developed by Jason Wu" << '\n' << '\n';
+
+    screen << "Scorecard" << '\n';
+    screen << "-------------------" << '\n';
+    
+    // Upper Section
+    screen << "UPPER SECTION" << '\n';
+    screen << "1s: "; draw_slot(ONES);
+    screen << "2s: "; draw_slot(TWOS);
+    screen << "3s: "; draw_slot(THREES);
+    screen << "4s: "; draw_slot(FOURS);
+    screen << "5s: "; draw_slot(FIVES);
+    screen << "6s: "; draw_slot(SIXES);
+    int upper_total = upper_subtotal(game);
+    int upper_section_bonus = upper_bonus(game);
+    screen << "Upper Section Bonus: ";
+    if (all_upper_final()) screen << YELLOW;
+    screen << upper_section_bonus << NORMAL << '\n'; // changed formatting of all finalized totals
+    screen << "Upper Total: ";
+    if (all_upper_final()) screen << YELLOW;
+    screen << upper_total + upper_section_bonus << NORMAL << '\n';
+
+    // Lower Section
+    screen << at(5, 26) << "| LOWER SECTION" << '\n';
+    screen << at(6, 26) << "| 3 of a Kind: "; draw_slot(THREE_OF_A_KIND);
+    screen << at(7, 26) << "| 4 of a Kind: "; draw_slot(FOUR_OF_A_KIND);
+    screen << at(8, 26) << "| Full House: "; draw_slot(FULL_HOUSE);
+    screen << at(9, 26) << "| Small Straight: "; draw_slot(SML_STRAIGHT);
+    screen << at(10, 26) << "| Large Straight: "; draw_slot(LRG_STRAIGHT);
+    screen << at(11, 26) << "| Yahtzee: "; draw_slot(YAHTZEE);
+    screen << at(12, 26) << "| Chance: "; draw_slot(CHANCE);
+
+    screen << at(13, 26) << "| Yahtzee Bonus: ";
+    if (game_over(game) || (is_filled(game, YAHTZEE) && !yahtzee_scored_50(game))) screen << YELLOW; // no more to earn
+    screen << yahtzee_bonus(game) << NORMAL << '\n';
+    screen << at(14, 26) << "| Lower Total: ";
+    if (all_lower_final()) screen << YELLOW;
+    screen << lower_total(game) + yahtzee_bonus(game) << NORMAL << '\n';
+    screen << "-------------------" << '\n'; //    ...including these two as well.
+    screen << "Grand Total: ";
+    if (all_upper_final() && all_lower_final()) screen << YELLOW;
+    screen << grand_total(game) << NORMAL << '\n';
+    if (solver_loaded()) {
+        char ev[32];
+        snprintf(ev, sizeof(ev), "%.1f", expected_final_score());
+        screen << at(15, 26) << "| Optimal EV: " << ev << '\n';
+    }
+    if (solver_loaded() && distribution_loaded()) {
+        char chance[32];
+        snprintf(chance, sizeof(chance), "%.0f%%", 100.0 * chance_at_least(game, TARGET_SCORE));
+        screen << at(16, 26) << "| Chance of " << TARGET_SCORE << "+: " << chance << '\n';
+    }
+    screen << "-------------------" << '\n' << '\n';
+}
+
+// every seat's scorecard in a column of its own, the seat to move's live one included
+void draw_scoreboard() {
+    const int LABEL_WIDTH = 16, COLUMN_WIDTH = 8;
+    const int first_row[2] = { 2, 9 };                  // upper and lower section
+    screen << at(1, 1) << "CL_Yahtzee";
+    for (int i = 0; i < int(seats.size()); ++i) {
+        const bool to_move = i == seat_to_move;
+        const GameState& g = to_move ? game : seats[i].game;
+        const int col = LABEL_WIDTH + 1 + i * COLUMN_WIDTH;
+        screen << at(1, col) << (to_move ? YELLOW : NORMAL) << (to_move ? ">" : " ")
+               << seats[i].name.substr(0, COLUMN_WIDTH - 2) << NORMAL;
+
+        for (int c = 0; c < NUM_CATEGORIES; ++c) {
+            const int row = c <= SIXES ? first_row[0] + c : first_row[1] + c - THREE_OF_A_KIND;
+            if (i == 0) screen << at(row, 1) << CATEGORY_NAMES[c];
+            screen << at(row, col + 1);
+            if (is_filled(g, Category(c))) screen << YELLOW << int(g.score[c]) << NORMAL;
+            else if (to_move && ((legal_categories(g) >> c) & 1)) screen << "(" << potential_score(g, Category(c)) << ")";
+            else screen << "-";
+        }
+        const bool upper_final = (g.filled & UPPER_MASK) == UPPER_MASK;
+        if (i == 0) screen << at(8, 1) << "Upper Bonus" << at(16, 1) << "Yahtzee Bonus" << at(17, 1) << "Grand Total";
+        screen << at(8, col + 1) << (upper_final ? YELLOW : NORMAL) << upper_bonus(g) << NORMAL;
+        screen << at(16, col + 1) << (game_over(g) ? YELLOW : NORMAL) << yahtzee_bonus(g) << NORMAL;
+        screen << at(17, col + 1) << (game_over(g) ? YELLOW : NORMAL) << grand_total(g) << NORMAL;
+    }
+}
+
+void draw_dice() {
+    screen << at(18, 1) << "Dice: ";
+    if (game.rolls == 0) screen << RED; // RED if no rolls left
+    screen << int(game.rolls) << " ROLL(S) LEFT";
+    if (game.rolls == 0) screen << NORMAL;
+    if (seats.size() > 1) screen << " | " << seats[seat_to_move].name << "'s turn";
+    screen << '\n' << '\n';
+    for (int i = 0; i < NUM_DICE; ++i) screen << "   " << int(game.dice[i]);
+    screen << '\n';
+    for (int i = 0; i < NUM_DICE; ++i) screen << "   " << ((game.held >> i) & 1 ? "H" : " ");
+    screen << '\n';
+    screen << "-------------------" << '\n';
+}
+
+
+void draw_commands_before_first_roll() {
+    screen << at(23, 1) << "[Space] : Roll all dice" << '\n' << '\n';
+}
+
+// record of every finished game so far, from the stats index
+void draw_stats(const StatsStore& stats, int row) {
+    if (stats.games() == 0) return;
+    char line[128];
+    snprintf(line, sizeof(line), "Your %llu game(s): best %d | average %.1f | median %d | top 10%% from %d",
+             (unsigned long long)stats.games(), stats.best(), stats.average(), stats.percentile(0.5), stats.percentile(0.9));
+    screen << at(row, 1) << line << '\n';
+}
+
+// optimal holds for the current dice, next to the hold commands (needs the solver table)
+void draw_hold_advice() {
+    HoldAdvice advice[3];
+    int n = advise_holds(game, advice, 3);
+    if (n == 0) return;
+    screen << at(23, 34) << "Best holds (expected final score):";
+    for (int i = 0; i < n; ++i) {
+        char line[48];
+        if (advice[i].mask == (1 << NUM_DICE) - 1) {
+            snprintf(line, sizeof(line), "%d. keep all, score now", i + 1);
+        } else if (advice[i].mask == 0) {
+            snprintf(line, sizeof(line), "%d. reroll everything", i + 1);
+        } else {
+            int len = snprintf(line, sizeof(line), "%d. hold", i + 1);
+            for (int d = 0; d < NUM_DICE; ++d)
+                if ((advice[i].mask >> d) & 1) len += snprintf(line + len, sizeof(line) - len, " D%d", d + 1);
+        }
+        char ev[16];
+        snprintf(ev, sizeof(ev), "%6.1f", advice[i].ev);
+        screen << at(24 + i, 34) << (i == 0 ? YELLOW : NORMAL) << line << at(24 + i, 60) << ev << NORMAL;
+    }
+}
+
+void draw_commands_after_dice_roll() {
+    screen << at(23, 1);
+    screen << "[1] Hold D1    [4] Hold D4" << '\n';
+    screen << "[2] Hold D2    [5] Hold D5" << '\n';
+    screen << "[3] Hold D3    [0] Submit" << '\n';
+    screen << "[Space] Reroll all unheld dice" << '\n' << '\n';
+}
+
+
+void draw_commands_select_section(int r) {
+    screen << at(23, 1) << "Select Section:" << '\n';
+    screen << "[1] Upper Section    [2] Lower Section" << '\n';
+    // screen << (r != 0 ? "[0] Return to previous menu" : "") << '\n' << '\n';
+    if (r != 0) {
+        screen << "[0] Return to previous menu" << '\n' << '\n';
+    } else {
+        screen << '\n' << '\n';
+    }
+}
+
+
+void draw_commands_select_upper_section() {
+    const bool ones_final = is_filled(game, ONES), twos_final = is_filled(game, TWOS),
+               threes_final = is_filled(game, THREES), fours_final = is_filled(game, FOURS),
+               fives_final = is_filled(game, FIVES), sixes_final = is_filled(game, SIXES);
+    screen << at(23, 1) << "Select slot from Upper Section:" << '\n';
+    if (!ones_final || !fours_final) // fixed indenting issues
+        screen << ( !ones_final ? "[1] 1s" : "      ") << "         " << ( !fours_final ? "[4] 4s" : "" ) << '\n';
+    if (!twos_final || !fives_final)
+        screen << ( !twos_final ? "[2] 2s" : "      ") << "         " << ( !fives_final ? "[5] 5s" : "" ) << '\n';
+    if (!threes_final || !sixes_final)
+        screen << ( !threes_final ? "[3] 3s" : "      ") << "         " << ( !sixes_final ? "[6] 6s" : "" ) << '\n';
+    screen << "[0] Return to previous menu" << '\n' << '\n';
+}
+
+void draw_commands_select_lower_section() {
+    const bool three_of_a_kind_final = is_filled(game, THREE_OF_A_KIND),
+               four_of_a_kind_final = is_filled(game, FOUR_OF_A_KIND),
+               full_house_final = is_filled(game, FULL_HOUSE),
+               sml_straight_final = is_filled(game, SML_STRAIGHT),
+               lrg_straight_final = is_filled(game, LRG_STRAIGHT),
+               yahtzee_final = is_filled(game, YAHTZEE), chance_final = is_filled(game, CHANCE);
+    screen << at(23, 1) << "Select slot from Lower Section:" << '\n';
+    // First column: 3K, FH, LS, Chance. Second: 4K, SS, Yahtzee
+    if (!three_of_a_kind_final || !four_of_a_kind_final) // fixed indenting issues
+        screen << ( !three_of_a_kind_final ? "[1] 3 of a Kind   " : "                  ")
+             << "   " << ( !four_of_a_kind_final ? "[2] 4 of a Kind" : "" ) << '\n';
+    if (!full_house_final || !sml_straight_final)
+        screen << ( !full_house_final ? "[3] Full House    " : "                  ")
+             << "   " << ( !sml_straight_final ? "[4] Small Straight" : "" ) << '\n';
+    if (!lrg_straight_final || !yahtzee_final)
+        screen << ( !lrg_straight_final ? "[5] Large Straight" : "                  ")
+             << "   " << ( !yahtzee_final ? "[6] Yahtzee" : "" ) << '\n';
+    if (!chance_final)
+        screen << "[7] Chance" << '\n';
+    screen << "[0] Return to previous menu" << '\n' << '\n';
+}
@@ -0,0 +1,54 @@
+// CL_Yahtzee screen layout
+// Scorecard, dice and command menus of the current game, drawn into the
+// off-screen frame. Nothing here touches the console (see flush_output_buffer).
+
+#pragma once
+
+#include "yahtzee.h"
+#include "screen.h"
+
+#include <string>
+#include <vector>
+
+class StatsStore;
+class Strategy;
+
+// scorecard, dice, holds and rolls for the current game
+extern GameState game;
+
+// Hot-seat play: up to MAX_SEATS players take turns, and draw_scorecard shows
+// every scorecard side by side once there's more than one. The seat to move
+// plays in game; the others keep theirs here until their turn.
+const int MAX_SEATS = 8;
+struct Seat {
+    std::string name;
+    GameState game;
+    const Strategy* ai = nullptr;   // null: played from the keyboard
+};
+extern std::vector<Seat> seats;
+extern int seat_to_move;
+extern const char* const CATEGORY_NAMES[NUM_CATEGORIES];
+
+// frames are drawn off-screen and only the cells that changed are written out
+extern Screen screen;
+
+void clear_screen();
+
+// finalization helper functions
+bool all_upper_final();
+bool all_lower_final();
+
+// optimal expected final score from here on (needs the solver table)
+double expected_final_score();
+
+void draw_slot(Category c);
+void draw_scorecard();
+void draw_scoreboard();
+void draw_dice();
+void draw_commands_before_first_roll();
+void draw_stats(const StatsStore& stats, int row);
+void draw_hold_advice();
+void draw_commands_after_dice_roll();
+void draw_commands_select_section(int r);
+void draw_commands_select_upper_section();
+void draw_commands_select_lower_section();
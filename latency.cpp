@@ -0,0 +1,125 @@
+// CL_Yahtzee latency instrumentation
+
+#include "latency.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+bool g_latency_on = false;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Power-of-two buckets: bucket b holds values in [2^(b-1), 2^b), bucket 0 holds 0.
+struct Histogram {
+    const char* name;
+    const char* unit;
+    uint64_t count = 0, sum = 0, max = 0;
+    uint64_t buckets[40] = {};
+
+    Histogram(const char* name, const char* unit) : name(name), unit(unit) {}
+
+    void add(uint64_t v) {
+        int b = 0;
+        while (b < 39 && (v >> b) != 0) ++b;
+        buckets[b]++;
+        count++;
+        sum += v;
+        if (v > max) max = v;
+    }
+
+    // upper bound of the bucket holding the q-th quantile
+    uint64_t quantile(double q) const {
+        uint64_t seen = 0, want = uint64_t(q * double(count - 1)) + 1;
+        for (int b = 0; b < 40; ++b) {
+            seen += buckets[b];
+            if (seen >= want) return b == 0 ? 0 : std::min(max, (uint64_t(1) << b) - 1);
+        }
+        return max;
+    }
+
+    void print(FILE* f) const {
+        fprintf(f, "%s (%s): count %llu", name, unit, (unsigned long long)count);
+        if (count) {
+            fprintf(f, ", mean %.1f, p50 <= %llu, p99 <= %llu, max %llu", double(sum) / double(count),
+                    (unsigned long long)quantile(0.5), (unsigned long long)quantile(0.99), (unsigned long long)max);
+        }
+        fprintf(f, "\n");
+        for (int b = 0; b < 40; ++b) {
+            if (!buckets[b]) continue;
+            const unsigned long long lo = b == 0 ? 0 : 1ull << (b - 1), hi = b == 0 ? 0 : (1ull << b) - 1;
+            fprintf(f, "  %10llu - %-10llu %10llu\n", lo, hi, (unsigned long long)buckets[b]);
+        }
+        fprintf(f, "\n");
+    }
+};
+
+Histogram input_to_paint("input to paint", "us");
+Histogram draw_to_flush("draw start to flush end", "us");
+Histogram frame_bytes("bytes written per frame", "bytes");
+Histogram anim_overrun("animation frame overrun", "us");
+
+std::string dump_path;
+Clock::time_point last_input, draw_start, anim_frame_start;
+bool input_pending = false, drawing = false, animating = false;
+
+int64_t micros(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+void dump_at_exit() { latency_dump(); }
+
+} // namespace
+
+void latency_enable(const char* path) {
+    dump_path = path;
+    if (!g_latency_on) atexit(dump_at_exit);
+    g_latency_on = true;
+}
+
+void latency_input_slow() {
+    last_input = Clock::now();
+    input_pending = true;
+}
+
+void latency_draw_start_slow() {
+    if (drawing) return; // a frame is built from several draw calls: time from the first
+    draw_start = Clock::now();
+    drawing = true;
+}
+
+void latency_flush_end_slow(size_t bytes) {
+    const Clock::time_point now = Clock::now();
+    if (drawing) draw_to_flush.add(uint64_t(micros(draw_start, now)));
+    // only the first paint after a key press answers it
+    if (input_pending) input_to_paint.add(uint64_t(micros(last_input, now)));
+    frame_bytes.add(bytes);
+    drawing = input_pending = false;
+}
+
+void latency_anim_frame_slow(int64_t frame_budget_us) {
+    const Clock::time_point now = Clock::now();
+    if (animating) {
+        const int64_t over = micros(anim_frame_start, now) - frame_budget_us;
+        anim_overrun.add(uint64_t(over > 0 ? over : 0));
+    }
+    anim_frame_start = now;
+    animating = true;
+}
+
+void latency_anim_end_slow() { animating = false; }
+
+bool latency_dump() {
+    if (!g_latency_on) return false;
+    FILE* f = fopen(dump_path.c_str(), "w");
+    if (!f) return false;
+    input_to_paint.print(f);
+    draw_to_flush.print(f);
+    frame_bytes.print(f);
+    anim_overrun.print(f);
+    return fclose(f) == 0;
+}
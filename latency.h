@@ -0,0 +1,35 @@
+// CL_Yahtzee latency instrumentation
+// Opt-in (--latency-log file): timestamps each key press, frame draw start and
+// flush, keeps histograms of where the time goes and writes them out at exit.
+// When it's off every hook is one predictable branch on a global flag.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+extern bool g_latency_on;
+
+// Starts recording; the histograms are written to path when the program exits.
+void latency_enable(const char* path);
+
+void latency_input_slow();
+void latency_draw_start_slow();
+void latency_flush_end_slow(size_t bytes);
+void latency_anim_frame_slow(int64_t frame_budget_us);
+void latency_anim_end_slow();
+
+// A key was just read.
+inline void latency_input() { if (g_latency_on) latency_input_slow(); }
+// A frame is about to be drawn.
+inline void latency_draw_start() { if (g_latency_on) latency_draw_start_slow(); }
+// A frame of `bytes` bytes has been written to the terminal.
+inline void latency_flush_end(size_t bytes) { if (g_latency_on) latency_flush_end_slow(bytes); }
+// An animation frame that should have taken frame_budget_us just ended (call
+// once per frame; the first call only starts the clock).
+inline void latency_anim_frame(int64_t frame_budget_us) { if (g_latency_on) latency_anim_frame_slow(frame_budget_us); }
+// The animation finished: the next latency_anim_frame starts a new one.
+inline void latency_anim_end() { if (g_latency_on) latency_anim_end_slow(); }
+
+// Writes the histograms now (also done automatically at exit).
+bool latency_dump();
@@ -0,0 +1,11 @@
+// CL_Yahtzee read-only file mapping (mmap / CreateFileMapping) for the
+// precomputed tables.
+
+#pragma once
+
+#include <cstddef>
+
+// Maps the whole file read-only. Returns null if it can't be opened or mapped;
+// size receives its length.
+const void* map_file(const char* path, size_t& size);
+void unmap_file(const void* data, size_t size);
@@ -0,0 +1,71 @@
+// CL_Yahtzee unbuffered files
+
+#include "raw_file.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <direct.h>
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+int open_file(const char* path, bool create) {
+    return _open(path, _O_RDWR | _O_BINARY | (create ? _O_CREAT : 0), _S_IREAD | _S_IWRITE);
+}
+int close_file(int fd) { return _close(fd); }
+int64_t file_size(int fd) { return _lseeki64(fd, 0, SEEK_END); }
+bool read_at(int fd, void* data, size_t size, uint64_t offset) {
+    return _lseeki64(fd, int64_t(offset), SEEK_SET) >= 0 && _read(fd, data, unsigned(size)) == int(size);
+}
+bool write_at(int fd, const void* data, size_t size, uint64_t offset) {
+    return _lseeki64(fd, int64_t(offset), SEEK_SET) >= 0 && _write(fd, data, unsigned(size)) == int(size);
+}
+bool sync_file(int fd) { return _commit(fd) == 0; }
+bool truncate_file(int fd, uint64_t size) { return _chsize_s(fd, int64_t(size)) == 0; }
+bool replace_file(const char* from, const char* to) {
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+bool make_directory(const char* path) { return _mkdir(path) == 0 || errno == EEXIST; }
+#else
+int open_file(const char* path, bool create) { return open(path, O_RDWR | (create ? O_CREAT : 0), 0644); }
+int close_file(int fd) { return close(fd); }
+int64_t file_size(int fd) { return int64_t(lseek(fd, 0, SEEK_END)); }
+bool read_at(int fd, void* data, size_t size, uint64_t offset) {
+    return pread(fd, data, size, off_t(offset)) == ssize_t(size);
+}
+bool write_at(int fd, const void* data, size_t size, uint64_t offset) {
+    return pwrite(fd, data, size, off_t(offset)) == ssize_t(size);
+}
+bool sync_file(int fd) { return fsync(fd) == 0; }
+bool truncate_file(int fd, uint64_t size) { return ftruncate(fd, off_t(size)) == 0; }
+bool replace_file(const char* from, const char* to) {
+    if (rename(from, to) != 0) return false;
+    // the rename lives in the directory: sync that too, or a crash can undo it
+    const char* slash = strrchr(to, '/');
+    const std::string dir = slash ? std::string(to, slash == to ? 1 : size_t(slash - to)) : ".";
+    const int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) return false;
+    const bool ok = fsync(fd) == 0;
+    return close(fd) == 0 && ok;
+}
+bool make_directory(const char* path) { return mkdir(path, 0755) == 0 || errno == EEXIST; }
+#endif
+
+uint32_t checksum(const void* data, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; ++i) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
@@ -0,0 +1,24 @@
+// CL_Yahtzee unbuffered files for the record stores (statistics, save slots):
+// positioned reads and writes that can be synced, truncated and atomically
+// replaced, on a plain descriptor (POSIX) or CRT handle (Windows).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Read-write, created if create is set. Returns -1 on failure.
+int open_file(const char* path, bool create);
+int close_file(int fd);
+int64_t file_size(int fd);
+bool read_at(int fd, void* data, size_t size, uint64_t offset);
+bool write_at(int fd, const void* data, size_t size, uint64_t offset);
+bool sync_file(int fd);
+bool truncate_file(int fd, uint64_t size);
+// Renames from over to, and returns once the rename is on disk.
+bool replace_file(const char* from, const char* to);
+// Creates the directory path (one level). True if it's there afterwards.
+bool make_directory(const char* path);
+
+// FNV-1a, for the records' checksums
+uint32_t checksum(const void* data, size_t size);
@@ -0,0 +1,114 @@
+// CL_Yahtzee replay logs
+
+#include "replay.h"
+#include "raw_file.h"
+
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+const char REPLAY_MAGIC[8] = { 'C', 'L', 'Y', 'Z', 'R', 'P', 0, 0 };
+
+struct ReplayFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t seed;
+};
+
+} // namespace
+
+bool ReplayWriter::open(const char* path, uint64_t seed) {
+    close();
+    file = fopen(path, "wb");
+    if (!file) return false;
+    ReplayFileHeader header;
+    std::memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+    header.version = REPLAY_VERSION;
+    header.reserved = 0;
+    header.seed = seed;
+    if (fwrite(&header, sizeof(header), 1, file) != 1 || fflush(file) != 0) {
+        close();
+        return false;
+    }
+    written = 0;
+    return true;
+}
+
+bool ReplayWriter::resume(const char* path, uint64_t seed, size_t events) {
+    close();
+    Replay log;
+    if (!read_replay(path, log) || log.seed != seed || log.events.size() < events) return false;
+    // cut in place, never rewritten: killed at any point, the log is still the game's
+    if (log.events.size() > events) {
+        const int fd = open_file(path, false);
+        if (fd < 0) return false;
+        const bool cut = truncate_file(fd, sizeof(ReplayFileHeader) + events);
+        if (close_file(fd) != 0 || !cut) return false;
+    }
+    file = fopen(path, "ab");
+    if (!file) return false;
+    written = events;
+    return true;
+}
+
+void ReplayWriter::close() {
+    if (file) fclose(file);
+    file = nullptr;
+}
+
+void ReplayWriter::put(uint8_t event) {
+    if (!file) return;
+    // one byte per player action: flushing each keeps the log current at no real cost
+    fputc(event, file);
+    fflush(file);
+    written++;
+}
+
+std::string replay_log_path(const char* dir, uint64_t seed, uint64_t started, uint32_t slot) {
+    const time_t t = time_t(started);
+    char stamp[32] = "00000000-000000";
+    if (const tm* local = localtime(&t)) strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", local);
+    // the slot keeps two games started the same second with the same seed apart, and
+    // unlike a pid it is known again when the game is resumed
+    return std::string(dir) + "/" + stamp + "-slot" + std::to_string(slot) + "-" + std::to_string(seed) + ".replay";
+}
+
+bool read_replay(const char* path, Replay& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    ReplayFileHeader header;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+              std::memcmp(header.magic, REPLAY_MAGIC, sizeof(header.magic)) == 0 &&
+              header.version == REPLAY_VERSION;
+    if (ok) {
+        out.seed = header.seed;
+        out.events.clear();
+        uint8_t buf[256];
+        for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0; ) out.events.insert(out.events.end(), buf, buf + n);
+        ok = !ferror(f);
+    }
+    fclose(f);
+    return ok;
+}
+
+bool apply_replay_event(GameState& g, DiceSource<Rng>& dice, uint8_t event) {
+    if (is_roll_event(event)) {
+        if (!has_rolled(g) && event != 0) return false; // nothing to hold before the first roll
+        const uint8_t held = g.held;
+        g.held = event;
+        if (!roll(g, dice)) { g.held = held; return false; }
+        return true;
+    }
+    return score_into(g, Category(event - REPLAY_SCORE));
+}
+
+size_t replay_game(const Replay& replay, GameState& g) {
+    g = GameState();
+    Rng rng(replay.seed);
+    DiceSource<Rng> dice(rng);
+    size_t applied = 0;
+    while (applied < replay.events.size() && apply_replay_event(g, dice, replay.events[applied])) applied++;
+    return applied;
+}
@@ -0,0 +1,72 @@
+// CL_Yahtzee replay logs
+// A game is recorded as its dice seed plus one byte per roll (with the dice
+// held for it) and per category choice. Replaying the events against the same
+// seed reproduces every roll, so a log is a complete record of the game.
+// Each game gets a log of its own, so older games can still be looked into.
+
+#pragma once
+
+#include "yahtzee.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+const char* const DEFAULT_REPLAY_DIR = "replays";
+const uint32_t REPLAY_VERSION = 3;    // 2: dice from DiceSource (base-6 digits), 3: Joker rules
+
+// Event bytes: 0x00..0x1f roll with that hold mask, REPLAY_SCORE + c score into c.
+const uint8_t REPLAY_SCORE = 0x20;
+inline uint8_t roll_event(uint8_t held) { return uint8_t(held & ((1 << NUM_DICE) - 1)); }
+inline uint8_t score_event(Category c) { return uint8_t(REPLAY_SCORE + c); }
+inline bool is_roll_event(uint8_t event) { return event < REPLAY_SCORE; }
+
+// Appends events to a log as they happen, so a crash or a closed window still
+// leaves everything up to the last action on disk.
+class ReplayWriter {
+public:
+    ReplayWriter() = default;
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+    ~ReplayWriter() { close(); }
+
+    // Starts a new log (replacing any old one) for a game rolled with a
+    // DiceSource over Rng(seed), kept for the whole game.
+    bool open(const char* path, uint64_t seed);
+    // Goes on with the log of a saved game that had logged events events:
+    // anything past them (logged after the save) is dropped. False if path
+    // isn't that game's log.
+    bool resume(const char* path, uint64_t seed, size_t events);
+    void close();
+    bool is_open() const { return file != nullptr; }
+    size_t events() const { return written; }
+
+    void roll(uint8_t held) { put(roll_event(held)); }
+    void score(Category c) { put(score_event(c)); }
+
+private:
+    void put(uint8_t event);
+    FILE* file = nullptr;
+    size_t written = 0;
+};
+
+// Where a game started at started (seconds since the Unix epoch) with seed in save
+// slot slot is logged by default: dir/<yyyymmdd-hhmmss>-slot<slot>-<seed>.replay,
+// in local time.
+std::string replay_log_path(const char* dir, uint64_t seed, uint64_t started, uint32_t slot);
+
+struct Replay {
+    uint64_t seed = 0;
+    std::vector<uint8_t> events;
+};
+
+// Reads a whole log. Returns false if missing or not a replay of this version.
+bool read_replay(const char* path, Replay& out);
+
+// Applies one event to g, rolling with dice. Returns false (g untouched) if the
+// event is not legal in g.
+bool apply_replay_event(GameState& g, DiceSource<Rng>& dice, uint8_t event);
+
+// Plays every event of replay from a new game into g. Returns the number of
+// events applied: less than replay.events.size() if one was illegal.
+size_t replay_game(const Replay& replay, GameState& g);
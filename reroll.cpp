@@ -0,0 +1,52 @@
+// CL_Yahtzee reroll transition tables
+
+#include "reroll.h"
+
+#include <vector>
+
+const RerollTables& reroll_tables() {
+    static const RerollTables* tables = [] {
+        // each keep's row: count every sequence of the rerolled dice by the
+        // hand it makes; a sequence of n dice is 6^(5 - n) 7776ths
+        std::vector<std::vector<uint16_t>> rows(NUM_KEEPS);
+        std::vector<bool> done(NUM_KEEPS, false);
+        for (int h = 0; h < NUM_HANDS; ++h) {
+            for (int mask = 0; mask < (1 << NUM_DICE); ++mask) {
+                const int k = keep_index(HAND_TABLES.dice[h], uint8_t(mask));
+                if (done[k]) continue;
+                done[k] = true;
+                rows[k].assign(NUM_HANDS, 0);
+                uint8_t dice[NUM_DICE];
+                int rolled = 0, scale = 1;
+                for (int i = 0; i < NUM_DICE; ++i) {
+                    dice[i] = HAND_TABLES.dice[h][i];
+                    if (!((mask >> i) & 1)) rolled++;
+                    else scale *= 6;
+                }
+                int sequences = 1;
+                for (int i = 0; i < rolled; ++i) sequences *= 6;
+                for (int s = 0; s < sequences; ++s) {
+                    int digits = s;
+                    for (int i = 0; i < NUM_DICE; ++i)
+                        if (!((mask >> i) & 1)) { dice[i] = uint8_t(digits % 6 + 1); digits /= 6; }
+                    rows[k][hand_index(dice)] += uint16_t(scale);
+                }
+            }
+        }
+
+        RerollTables* t = new RerollTables();
+        int n = 0;
+        for (int k = 0; k < NUM_KEEPS; ++k) {
+            t->row_begin[k] = uint16_t(n);
+            for (int h = 0; h < NUM_HANDS; ++h) {
+                if (!rows[k][h]) continue;
+                t->hand[n] = uint8_t(h);
+                t->weight[n] = rows[k][h];
+                n++;
+            }
+        }
+        t->row_begin[NUM_KEEPS] = uint16_t(n);
+        return t;
+    }();
+    return *tables;
+}
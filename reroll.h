@@ -0,0 +1,35 @@
+// CL_Yahtzee reroll transition tables
+// Where rolling leads: for each keep (one of the 462 multisets of held dice,
+// numbered as in the solver) the hands the other dice can turn it into, with
+// exact probabilities in 1/7776ths (6^5: every reroll's outcomes are a whole
+// number of those). The rows are stored back to back (compressed sparse rows),
+// 4368 entries in all, so a hold is valued with one short dot product.
+
+#pragma once
+
+#include "solver.h"
+
+const int REROLL_DENOMINATOR = 7776;
+const int REROLL_ENTRIES = 4368;
+
+struct RerollTables {
+    uint16_t row_begin[NUM_KEEPS + 1];  // keep k's entries are [row_begin[k], row_begin[k + 1])
+    uint8_t hand[REROLL_ENTRIES];       // hand rolled into
+    uint16_t weight[REROLL_ENTRIES];    // its probability times REROLL_DENOMINATOR
+};
+
+// Built on first use.
+const RerollTables& reroll_tables();
+
+// Expected hand_value (one value per hand) after rolling the dice keep leaves out.
+inline float keep_ev(int keep, const float* hand_value) {
+    const RerollTables& t = reroll_tables();
+    float sum = 0.0f;
+    for (int i = t.row_begin[keep]; i < t.row_begin[keep + 1]; ++i) sum += float(t.weight[i]) * hand_value[t.hand[i]];
+    return sum * (1.0f / REROLL_DENOMINATOR);
+}
+
+// The same for holding the dice in mask and rolling the rest.
+inline float hold_ev(const uint8_t dice[NUM_DICE], uint8_t mask, const float* hand_value) {
+    return keep_ev(keep_index(dice, mask), hand_value);
+}
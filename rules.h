@@ -0,0 +1,191 @@
+// CL_Yahtzee scoring rules for any variant
+// A variant is a struct of constexpr parameters: dice, faces, the scoring rule
+// of each category and the upper bonus. Everything derived from it (the hands,
+// their O(1) index and every hand's score in every category) is built at
+// compile time into a HandTable, so scoring is a table lookup in every variant.
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+enum ScoreRule : uint8_t {
+    COUNT_ONES, COUNT_TWOS, COUNT_THREES, COUNT_FOURS, COUNT_FIVES, COUNT_SIXES, // the dice showing that face
+    KIND_3_SUM_ALL, KIND_4_SUM_ALL,         // all the dice, if that many match (Yahtzee)
+    FULL_HOUSE_25, RUN_4_30, RUN_5_40,      // fixed points (Yahtzee)
+    ALL_SAME_50, ALL_SAME_100,              // every die the same
+    ONE_PAIR, TWO_PAIRS, THREE_PAIRS,       // the matching dice, highest first (Yatzy)
+    KIND_3, KIND_4, KIND_5,
+    FULL_HOUSE_SUM, VILLA, TOWER,           // 3 + 2, 3 + 3 and 4 + 2 matching dice (Yatzy)
+    STRAIGHT_1_5, STRAIGHT_2_6, STRAIGHT_1_6, // the sum of those faces (Yatzy)
+    SUM_ALL                                 // chance
+};
+
+// Highest face with at least n dice that isn't skip or skip2 (0 if none).
+constexpr int highest_with(const int counts[], int faces, int n, int skip = 0, int skip2 = 0) {
+    for (int v = faces; v >= 1; --v)
+        if (counts[v] >= n && v != skip && v != skip2) return v;
+    return 0;
+}
+
+// Best of big * a + small * b over faces a != b with at least big and small dice.
+constexpr int best_split(const int counts[], int faces, int big, int small) {
+    int best = 0;
+    for (int a = 1; a <= faces; ++a) {
+        const int b = counts[a] >= big ? highest_with(counts, faces, small, a) : 0;
+        if (b && big * a + small * b > best) best = big * a + small * b;
+    }
+    return best;
+}
+
+// Points for a hand with counts[v] dice showing v under one rule.
+constexpr int rule_score(const int counts[], int dice, int faces, ScoreRule rule) {
+    int sum = 0, max_count = 0, run = 0, longest_run = 0;
+    bool has2 = false, has3 = false;
+    for (int v = 1; v <= faces; ++v) {
+        sum += counts[v] * v;
+        if (counts[v] > max_count) max_count = counts[v];
+        if (counts[v] == 2) has2 = true;
+        if (counts[v] == 3) has3 = true;
+        run = counts[v] ? run + 1 : 0;
+        if (run > longest_run) longest_run = run;
+    }
+    auto all_of = [&](int first, int last) {
+        for (int v = first; v <= last; ++v) if (v > faces || !counts[v]) return false;
+        return true;
+    };
+    const int pair = highest_with(counts, faces, 2);
+    const int pair2 = highest_with(counts, faces, 2, pair);
+    const int pair3 = highest_with(counts, faces, 2, pair, pair2);
+    switch (rule) {
+        case COUNT_ONES: case COUNT_TWOS: case COUNT_THREES: case COUNT_FOURS: case COUNT_FIVES: case COUNT_SIXES:
+            return rule < faces ? counts[rule + 1] * (rule + 1) : 0;
+        case KIND_3_SUM_ALL: return max_count >= 3 ? sum : 0;
+        case KIND_4_SUM_ALL: return max_count >= 4 ? sum : 0;
+        case FULL_HOUSE_25:  return has3 && has2 ? 25 : 0;
+        case RUN_4_30:       return longest_run >= 4 ? 30 : 0;
+        case RUN_5_40:       return longest_run >= 5 ? 40 : 0;
+        case ALL_SAME_50:    return max_count == dice ? 50 : 0;
+        case ALL_SAME_100:   return max_count == dice ? 100 : 0;
+        case ONE_PAIR:       return 2 * pair;
+        case TWO_PAIRS:      return pair2 ? 2 * (pair + pair2) : 0;
+        case THREE_PAIRS:    return pair3 ? 2 * (pair + pair2 + pair3) : 0;
+        case KIND_3:         return 3 * highest_with(counts, faces, 3);
+        case KIND_4:         return 4 * highest_with(counts, faces, 4);
+        case KIND_5:         return 5 * highest_with(counts, faces, 5);
+        case FULL_HOUSE_SUM: return best_split(counts, faces, 3, 2);
+        case VILLA:          return best_split(counts, faces, 3, 3);
+        case TOWER:          return best_split(counts, faces, 4, 2);
+        case STRAIGHT_1_5:   return all_of(1, 5) ? 15 : 0;
+        case STRAIGHT_2_6:   return all_of(2, 6) ? 20 : 0;
+        case STRAIGHT_1_6:   return all_of(1, 6) ? 21 : 0;
+        case SUM_ALL:        return sum;
+        default:             return 0;
+    }
+}
+
+constexpr int choose(int n, int k) {
+    int r = 1;
+    for (int i = 1; i <= k; ++i) r = r * (n - k + i) / i;
+    return r;
+}
+constexpr int power(int base, int exp) { return exp == 0 ? 1 : base * power(base, exp - 1); }
+
+// Every distinct (sorted) hand of a variant with its category scores. A hand's
+// key sums (DICE + 1)^(face - 1) over its dice, so it only depends on how many
+// dice show each face; index_of_key turns it into the hand's index.
+template <class V>
+struct HandTable {
+    static constexpr int DICE = V::DICE;
+    static constexpr int FACES = V::FACES;
+    static constexpr int CATEGORIES = V::NUM_CATEGORIES;
+    static constexpr int HANDS = choose(FACES + DICE - 1, DICE);
+    static constexpr int KEYS = DICE * power(DICE + 1, FACES - 1) + 1;
+    using Index = typename std::conditional<(HANDS <= 256), uint8_t, uint16_t>::type;
+    static_assert(FACES <= 6 && DICE <= 8, "upper categories go up to sixes; holds are a byte");
+
+    int key_weight[FACES + 1];          // key of one die showing face f (0 for f = 0)
+    Index index_of_key[KEYS];           // hand key -> hand index (unused keys map to 0)
+    uint8_t dice[HANDS][DICE];          // sorted faces of each hand
+    uint8_t score[HANDS][CATEGORIES];
+    uint8_t max_score[CATEGORIES];      // best any hand scores in each category
+};
+
+template <class V>
+constexpr HandTable<V> make_hand_table() {
+    using T = HandTable<V>;
+    T t{};
+    for (int f = 1; f <= T::FACES; ++f) t.key_weight[f] = power(T::DICE + 1, f - 1);
+    // hands in lexicographic order of their sorted faces
+    int faces[T::DICE] = {};
+    for (int i = 0; i < T::DICE; ++i) faces[i] = 1;
+    for (int h = 0; h < T::HANDS; ++h) {
+        int counts[T::FACES + 1] = {};
+        int key = 0;
+        for (int i = 0; i < T::DICE; ++i) {
+            t.dice[h][i] = uint8_t(faces[i]);
+            counts[faces[i]]++;
+            key += t.key_weight[faces[i]];
+        }
+        t.index_of_key[key] = typename T::Index(h);
+        for (int c = 0; c < T::CATEGORIES; ++c) {
+            t.score[h][c] = uint8_t(rule_score(counts, T::DICE, T::FACES, V::CATEGORIES[c]));
+            if (t.score[h][c] > t.max_score[c]) t.max_score[c] = t.score[h][c];
+        }
+        // next non-decreasing sequence: bump the last die below FACES, reset the rest to it
+        int i = T::DICE - 1;
+        while (i > 0 && faces[i] == T::FACES) --i;
+        faces[i]++;
+        for (int j = i + 1; j < T::DICE; ++j) faces[j] = faces[i];
+    }
+    return t;
+}
+
+template <class V>
+inline constexpr HandTable<V> HAND_TABLE = make_hand_table<V>();
+
+// Index of the hand shown by V::DICE dice, in any order.
+template <class V>
+inline int variant_hand_index(const uint8_t* dice) {
+    int key = 0;
+    for (int i = 0; i < V::DICE; ++i) key += HAND_TABLE<V>.key_weight[dice[i]];
+    return HAND_TABLE<V>.index_of_key[key];
+}
+
+// --- the variants ---
+
+// Yahtzee as this game plays it (GameState adds the Yahtzee bonus and Jokers).
+struct ClassicYahtzee {
+    static constexpr const char* NAME = "yahtzee";
+    static constexpr int DICE = 5, FACES = 6, NUM_CATEGORIES = 13, UPPER_CATEGORIES = 6;
+    static constexpr int UPPER_BONUS_THRESHOLD = 63, UPPER_BONUS = 35;
+    static constexpr ScoreRule CATEGORIES[NUM_CATEGORIES] = {
+        COUNT_ONES, COUNT_TWOS, COUNT_THREES, COUNT_FOURS, COUNT_FIVES, COUNT_SIXES,
+        KIND_3_SUM_ALL, KIND_4_SUM_ALL, FULL_HOUSE_25, RUN_4_30, RUN_5_40, ALL_SAME_50, SUM_ALL
+    };
+};
+
+// Scandinavian Yatzy: pairs, kinds and houses score the matching dice, and
+// the straights are fixed (1-5 and 2-6).
+struct Yatzy {
+    static constexpr const char* NAME = "yatzy";
+    static constexpr int DICE = 5, FACES = 6, NUM_CATEGORIES = 15, UPPER_CATEGORIES = 6;
+    static constexpr int UPPER_BONUS_THRESHOLD = 63, UPPER_BONUS = 50;
+    static constexpr ScoreRule CATEGORIES[NUM_CATEGORIES] = {
+        COUNT_ONES, COUNT_TWOS, COUNT_THREES, COUNT_FOURS, COUNT_FIVES, COUNT_SIXES,
+        ONE_PAIR, TWO_PAIRS, KIND_3, KIND_4, STRAIGHT_1_5, STRAIGHT_2_6, FULL_HOUSE_SUM, SUM_ALL, ALL_SAME_50
+    };
+};
+
+// Maxi Yatzy: six dice, with three pairs, five of a kind, the full straight,
+// villa (3 + 3) and tower (4 + 2), and 100 for six of a kind.
+struct MaxiYatzy {
+    static constexpr const char* NAME = "maxi";
+    static constexpr int DICE = 6, FACES = 6, NUM_CATEGORIES = 20, UPPER_CATEGORIES = 6;
+    static constexpr int UPPER_BONUS_THRESHOLD = 84, UPPER_BONUS = 100;
+    static constexpr ScoreRule CATEGORIES[NUM_CATEGORIES] = {
+        COUNT_ONES, COUNT_TWOS, COUNT_THREES, COUNT_FOURS, COUNT_FIVES, COUNT_SIXES,
+        ONE_PAIR, TWO_PAIRS, THREE_PAIRS, KIND_3, KIND_4, KIND_5, STRAIGHT_1_5, STRAIGHT_2_6, STRAIGHT_1_6,
+        FULL_HOUSE_SUM, VILLA, TOWER, SUM_ALL, ALL_SAME_100
+    };
+};
@@ -0,0 +1,93 @@
+// CL_Yahtzee off-screen frame buffer
+
+#include "screen.h"
+
+#include <cstdio>
+
+namespace {
+
+// re-sending a few unchanged cells is cheaper than a cursor move (at least 6 bytes)
+const int MAX_GAP = 4;
+
+} // namespace
+
+void Screen::clear() {
+    for (int r = 0; r < ROWS; ++r)
+        for (int c = 0; c < COLS; ++c) next[r][c] = Cell{ ' ', NORMAL };
+    row = col = 0;
+    color = NORMAL;
+}
+
+void Screen::terminal_cleared() {
+    for (int r = 0; r < ROWS; ++r)
+        for (int c = 0; c < COLS; ++c) shown[r][c] = Cell{ ' ', NORMAL };
+}
+
+Screen& Screen::operator<<(char ch) {
+    if (ch == '\n') {
+        row++;
+        col = 0;
+    } else if (ch == '\b') {
+        if (col > 0) col--;
+    } else {
+        if (row >= 0 && row < ROWS && col >= 0 && col < COLS) next[row][col] = Cell{ ch, color };
+        col++;
+    }
+    return *this;
+}
+
+Screen& Screen::operator<<(const char* text) {
+    while (*text) *this << *text++;
+    return *this;
+}
+
+Screen& Screen::operator<<(int value) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%d", value);
+    return *this << buf;
+}
+
+void Screen::diff(std::vector<Run>& runs) {
+    runs.clear();
+    for (int r = 0; r < ROWS; ++r) {
+        int c = 0;
+        while (c < COLS) {
+            if (next[r][c] == shown[r][c]) { ++c; continue; }
+            Run run{ r + 1, c + 1, next[r][c].color, std::string() };
+            int end = c;    // one past the last changed cell in the run
+            for (int i = c; i < COLS && next[r][i].color == run.color && i - end < MAX_GAP; ++i)
+                if (!(next[r][i] == shown[r][i])) end = i + 1;
+            for (int i = c; i < end; ++i) {
+                run.text += next[r][i].ch;
+                shown[r][i] = next[r][i];
+            }
+            runs.push_back(run);
+            c = end;
+        }
+    }
+}
+
+std::string ansi_frame(const std::vector<Run>& runs, int row, int col) {
+    static const char* const SGR[] = { "\033[0m", "\033[33m", "\033[31m" };
+    std::string out;
+    int cur_row = -1, cur_col = -1;
+    Color cur_color = NORMAL;
+    char move[24];
+    for (const Run& run : runs) {
+        if (run.row != cur_row || run.col != cur_col) {
+            snprintf(move, sizeof(move), "\033[%d;%dH", run.row, run.col);
+            out += move;
+        }
+        if (run.color != cur_color) out += SGR[run.color];
+        out += run.text;
+        cur_row = run.row;
+        cur_col = run.col + int(run.text.size());
+        cur_color = run.color;
+    }
+    if (cur_color != NORMAL) out += SGR[NORMAL];
+    if (row != cur_row || col != cur_col) {
+        snprintf(move, sizeof(move), "\033[%d;%dH", row, col);
+        out += move;
+    }
+    return out;
+}
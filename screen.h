@@ -0,0 +1,65 @@
+// CL_Yahtzee off-screen frame buffer
+// Frames are drawn into a grid of cells and only the cells that changed since
+// the previous frame are sent to the terminal.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum Color : uint8_t { NORMAL, YELLOW, RED };
+
+// Cursor position to stream into a Screen (1-based, like the escape sequence it replaces).
+struct At { int row, col; };
+inline At at(int row, int col) { return At{ row, col }; }
+
+// Text that changed since the last frame, all in one colour.
+struct Run {
+    int row, col;
+    Color color;
+    std::string text;
+};
+
+class Screen {
+public:
+    static const int ROWS = 32;
+    static const int COLS = 80;
+
+    Screen() { clear(); terminal_cleared(); }
+
+    // Starts a new frame: blank cells, cursor home. The terminal is untouched.
+    void clear();
+    // Tells the screen the terminal was blanked, so the next diff paints every non-blank cell.
+    void terminal_cleared();
+
+    // '\n' moves to the start of the next row and '\b' one column back;
+    // anything outside the grid is dropped.
+    Screen& operator<<(const char* text);
+    Screen& operator<<(const std::string& text) { return *this << text.c_str(); }
+    Screen& operator<<(char ch);
+    Screen& operator<<(int value);
+    Screen& operator<<(Color c) { color = c; return *this; }
+    Screen& operator<<(At pos) { row = pos.row - 1; col = pos.col - 1; return *this; }
+
+    // Runs of cells that differ from the previous frame; the current frame
+    // becomes the reference for the next call.
+    void diff(std::vector<Run>& runs);
+
+    int cursor_row() const { return row + 1; }
+    int cursor_col() const { return col + 1; }
+
+private:
+    struct Cell {
+        char ch;
+        Color color;
+        bool operator==(const Cell& o) const { return ch == o.ch && color == o.color; }
+    };
+    Cell next[ROWS][COLS];
+    Cell shown[ROWS][COLS];
+    int row = 0, col = 0;
+    Color color = NORMAL;
+};
+
+// VT/ANSI bytes that paint runs and then leave the cursor at (row, col).
+std::string ansi_frame(const std::vector<Run>& runs, int row, int col);
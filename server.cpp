@@ -0,0 +1,381 @@
+// CL_Yahtzee game server
+
+#include "server.h"
+
+#include <cstdio>
+
+#ifdef __linux__
+
+#include "yahtzee.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const char* const CATEGORY_TOKENS[NUM_CATEGORIES] = {
+    "ones", "twos", "threes", "fours", "fives", "sixes",
+    "3kind", "4kind", "fullhouse", "smstraight", "lgstraight", "yahtzee", "chance"
+};
+
+// One hosted game. Slots are reused; the generation tells a stale id from the
+// game now in its slot.
+struct Session {
+    GameState game;
+    Rng rng;
+    DiceSource<Rng> dice{rng};
+    uint32_t generation = 0;
+    uint32_t owner = 0;         // connection that made it, 0 if the slot is free
+    uint32_t next_free = 0;
+    uint32_t prev_owned = 0, next_owned = 0;    // the owner's other games
+};
+
+// Sessions live in fixed pages that never move, handed out from a free list.
+// Each connection's games are linked through their slots from a head the
+// connection keeps (owned), so closing it frees just those games.
+class SessionSlab {
+public:
+    static const uint32_t PAGE = 4096;
+    static const uint32_t NONE = 0xffffffffu;
+
+    uint64_t create(uint32_t owner, uint64_t seed, uint32_t& owned) {
+        uint32_t slot = free_head;
+        if (slot == NONE) {
+            if (capacity % PAGE == 0) pages.emplace_back(new Session[PAGE]);
+            slot = capacity++;
+        } else {
+            free_head = at(slot).next_free;
+        }
+        Session& s = at(slot);
+        s.game = GameState();
+        s.rng = Rng(seed);
+        new (&s.dice) DiceSource<Rng>(s.rng); // drop the last game's spare dice
+        s.owner = owner;
+        s.prev_owned = NONE;
+        s.next_owned = owned;
+        if (owned != NONE) at(owned).prev_owned = slot;
+        owned = slot;
+        return (uint64_t(s.generation) << 32) | slot;
+    }
+
+    Session* find(uint64_t id, uint32_t owner) {
+        const uint32_t slot = uint32_t(id);
+        if (slot >= capacity) return nullptr;
+        Session& s = at(slot);
+        return s.owner == owner && s.generation == uint32_t(id >> 32) ? &s : nullptr;
+    }
+
+    void destroy(uint32_t slot, uint32_t& owned) {
+        Session& s = at(slot);
+        if (s.prev_owned != NONE) at(s.prev_owned).next_owned = s.next_owned;
+        else owned = s.next_owned;
+        if (s.next_owned != NONE) at(s.next_owned).prev_owned = s.prev_owned;
+        s.owner = 0;
+        s.generation++;
+        s.next_free = free_head;
+        free_head = slot;
+    }
+
+    void destroy_owned(uint32_t& owned) {
+        while (owned != NONE) destroy(owned, owned);
+    }
+
+private:
+    Session& at(uint32_t slot) { return pages[slot / PAGE][slot % PAGE]; }
+
+    std::vector<std::unique_ptr<Session[]>> pages;
+    uint32_t capacity = 0, free_head = NONE;
+};
+
+struct Connection {
+    Connection(uint32_t id, int in_fd, int out_fd) : id(id), in_fd(in_fd), out_fd(out_fd) {}
+    uint32_t id;
+    int in_fd, out_fd;
+    std::string in, out;
+    uint32_t owned = SessionSlab::NONE;         // first slot of this connection's games
+    bool closing = false;
+    uint32_t events = 0;        // what the fd is registered for in epoll
+};
+
+// a client that sends without reading stops being read once this much output is queued
+const size_t MAX_BACKLOG = 1 << 20;
+// and one that sends a line longer than this is cut off
+const size_t MAX_LINE = 4096;
+
+SessionSlab sessions;
+uint64_t server_seed = 0, games_started = 0;
+uint32_t next_connection = 1;
+
+void append_uint(std::string& out, uint64_t v) {
+    char buf[24];
+    int n = 0;
+    do buf[n++] = char('0' + v % 10); while (v /= 10);
+    while (n) out += buf[--n];
+}
+
+bool parse_uint(std::string_view s, uint64_t& v) {
+    if (s.empty() || s.size() > 20) return false;
+    v = 0;
+    for (char ch : s) {
+        if (ch < '0' || ch > '9') return false;
+        if (v > (UINT64_MAX - uint64_t(ch - '0')) / 10) return false; // would wrap
+        v = v * 10 + uint64_t(ch - '0');
+    }
+    return true;
+}
+
+int parse_category(std::string_view s) {
+    uint64_t n;
+    if (parse_uint(s, n)) return n < NUM_CATEGORIES ? int(n) : -1;
+    for (int c = 0; c < NUM_CATEGORIES; ++c)
+        if (s == CATEGORY_TOKENS[c]) return c;
+    return -1;
+}
+
+void append_dice(std::string& out, const GameState& g) {
+    out += " dice";
+    for (int i = 0; i < NUM_DICE; ++i) { out += ' '; out += char('0' + g.dice[i]); }
+}
+
+void append_held(std::string& out, const GameState& g) {
+    out += " held ";
+    for (int i = 0; i < NUM_DICE; ++i) out += (g.held >> i) & 1 ? '1' : '0';
+}
+
+void handle_line(Connection& conn, std::string_view line) {
+    std::string_view tok[8];
+    int n = 0;
+    for (size_t i = 0; i < line.size() && n < 8; ) {
+        while (i < line.size() && line[i] == ' ') ++i;
+        const size_t start = i;
+        while (i < line.size() && line[i] != ' ') ++i;
+        if (i > start) tok[n++] = line.substr(start, i - start);
+    }
+    if (n == 0) return;
+    std::string& out = conn.out;
+
+    if (tok[0] == "new") {
+        uint64_t seed;
+        if (n < 2) seed = Rng::stream(server_seed, games_started)();
+        else if (!parse_uint(tok[1], seed)) { out += "err bad seed\n"; return; }
+        games_started++;
+        out += "ok ";
+        append_uint(out, sessions.create(conn.id, seed, conn.owned));
+        out += '\n';
+        return;
+    }
+    if (tok[0] == "quit") { conn.closing = true; return; }
+
+    uint64_t id;
+    Session* s = parse_uint(tok[0], id) ? sessions.find(id, conn.id) : nullptr;
+    if (!s) { out += "err no such game\n"; return; }
+    if (n < 2) { out += "err missing command\n"; return; }
+    GameState& g = s->game;
+    const std::string_view cmd = tok[1];
+
+    if (cmd == "roll") {
+        if (!roll(g, s->dice)) { out += game_over(g) ? "err game over\n" : "err no rolls left\n"; return; }
+        out += "ok";
+        append_dice(out, g);
+        out += " rolls ";
+        out += char('0' + g.rolls);
+        out += '\n';
+    } else if (cmd == "hold") {
+        if (!has_rolled(g)) { out += "err not rolled\n"; return; }
+        const uint8_t before = g.held;
+        for (int i = 2; i < n; ++i) {
+            uint64_t die;
+            if (!parse_uint(tok[i], die) || die < 1 || die > NUM_DICE) { g.held = before; out += "err bad die\n"; return; }
+            toggle_hold(g, int(die) - 1);
+        }
+        out += "ok";
+        append_held(out, g);
+        out += '\n';
+    } else if (cmd == "score") {
+        const int c = n > 2 ? parse_category(tok[2]) : -1;
+        if (c < 0) { out += "err bad category\n"; return; }
+        const int points = has_rolled(g) ? potential_score(g, Category(c)) : 0;
+        if (!score_into(g, Category(c))) {
+            out += !has_rolled(g) ? "err not rolled\n" : is_filled(g, Category(c)) ? "err category filled\n" : "err joker rules\n";
+            return;
+        }
+        out += "ok points ";
+        append_uint(out, uint64_t(points));
+        out += " total ";
+        append_uint(out, uint64_t(grand_total(g)));
+        out += game_over(g) ? " over\n" : "\n";
+    } else if (cmd == "state") {
+        out += "ok rolls ";
+        out += char('0' + g.rolls);
+        append_dice(out, g);
+        append_held(out, g);
+        out += " scores";
+        for (int c = 0; c < NUM_CATEGORIES; ++c) {
+            out += ' ';
+            if (is_filled(g, Category(c))) append_uint(out, g.score[c]);
+            else out += '-';
+        }
+        out += " total ";
+        append_uint(out, uint64_t(grand_total(g)));
+        out += '\n';
+    } else if (cmd == "end") {
+        sessions.destroy(uint32_t(id), conn.owned);
+        out += "ok\n";
+    } else {
+        out += "err unknown command\n";
+    }
+}
+
+// Handles every complete line in conn.in. A line over MAX_LINE, finished or
+// not, ends the connection (so what's pending never grows past it).
+void handle_input(Connection& conn) {
+    size_t start = 0;
+    for (size_t nl; !conn.closing && (nl = conn.in.find('\n', start)) != std::string::npos; start = nl + 1) {
+        if (nl - start > MAX_LINE) break;
+        size_t end = nl;
+        if (end > start && conn.in[end - 1] == '\r') end--;
+        handle_line(conn, std::string_view(conn.in).substr(start, end - start));
+    }
+    conn.in.erase(0, start);
+    if (!conn.closing && conn.in.size() > MAX_LINE) {
+        conn.out += "err line too long\n";
+        conn.closing = true;
+    }
+    if (conn.closing) conn.in.clear();
+}
+
+// Writes as much of conn.out as the fd takes. Returns false on a write error.
+bool write_pending(Connection& conn) {
+    size_t done = 0;
+    while (done < conn.out.size()) {
+        const ssize_t n = write(conn.out_fd, conn.out.data() + done, conn.out.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+        done += size_t(n);
+    }
+    conn.out.erase(0, done);
+    return true;
+}
+
+int serve_stdio() {
+    Connection conn(next_connection++, 0, 1);
+    char buf[1 << 16];
+    for (ssize_t n; !conn.closing && (n = read(0, buf, sizeof(buf))) != 0; ) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return 1;
+        }
+        conn.in.append(buf, size_t(n));
+        handle_input(conn);
+        if (!write_pending(conn)) return 1;
+    }
+    return 0;
+}
+
+int serve_socket(const char* path) {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) { fprintf(stderr, "Socket path too long: %s\n", path); return 1; }
+    strcpy(addr.sun_path, path);
+    const int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(path);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        fprintf(stderr, "Could not listen on %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    const int ep = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr; // the listener
+    epoll_ctl(ep, EPOLL_CTL_ADD, listener, &ev);
+    fprintf(stderr, "Serving on %s\n", path);
+
+    auto close_connection = [&](Connection* conn) {
+        epoll_ctl(ep, EPOLL_CTL_DEL, conn->in_fd, nullptr);
+        close(conn->in_fd);
+        sessions.destroy_owned(conn->owned);
+        delete conn;
+    };
+
+    epoll_event events[256];
+    for (;;) {
+        const int ready = epoll_wait(ep, events, 256, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            return 1;
+        }
+        for (int e = 0; e < ready; ++e) {
+            Connection* conn = static_cast<Connection*>(events[e].data.ptr);
+            if (!conn) {
+                for (int fd; (fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0; ) {
+                    Connection* c = new Connection(next_connection++, fd, fd);
+                    epoll_event cev = {};
+                    cev.events = c->events = EPOLLIN;
+                    cev.data.ptr = c;
+                    epoll_ctl(ep, EPOLL_CTL_ADD, fd, &cev);
+                }
+                continue;
+            }
+
+            bool alive = !(events[e].events & EPOLLERR);
+            if (alive && (events[e].events & (EPOLLIN | EPOLLHUP))) {
+                char buf[1 << 16];
+                // lines are handled as each chunk arrives, so at most a line and a chunk are held
+                // (and reading stops while the replies back up)
+                while (!conn->closing && conn->out.size() < MAX_BACKLOG) {
+                    const ssize_t n = read(conn->in_fd, buf, sizeof(buf));
+                    if (n > 0) { conn->in.append(buf, size_t(n)); handle_input(*conn); continue; }
+                    if (n == 0) alive = false;
+                    else if (errno == EINTR) continue;
+                    else if (errno != EAGAIN && errno != EWOULDBLOCK) alive = false;
+                    break;
+                }
+            }
+            if (alive && !write_pending(*conn)) alive = false;
+            if (!alive || (conn->closing && conn->out.empty())) { close_connection(conn); continue; }
+
+            // only wait for writability while output is backed up
+            uint32_t want = !conn->closing && conn->out.size() < MAX_BACKLOG ? uint32_t(EPOLLIN) : 0;
+            if (!conn->out.empty()) want |= EPOLLOUT;
+            if (want != conn->events) {
+                epoll_event cev = {};
+                cev.events = conn->events = want;
+                cev.data.ptr = conn;
+                epoll_ctl(ep, EPOLL_CTL_MOD, conn->in_fd, &cev);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int run_server(const char* socket_path, uint64_t seed) {
+    signal(SIGPIPE, SIG_IGN); // a client going away is an error return, not a kill
+    server_seed = seed;
+    return socket_path ? serve_socket(socket_path) : serve_stdio();
+}
+
+#else
+
+int run_server(const char*, uint64_t) {
+    fprintf(stderr, "--serve needs Linux (epoll)\n");
+    return 1;
+}
+
+#endif
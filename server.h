@@ -0,0 +1,26 @@
+// CL_Yahtzee game server
+// Hosts many independent headless games in one process, driven by a line
+// protocol over stdin/stdout or a Unix domain socket (Linux only: epoll).
+//
+//   new [seed]          -> ok <id>              start a game
+//   <id> roll           -> ok dice 3 1 6 6 2 rolls 2
+//   <id> hold 1 [2 ...] -> ok held 10000        toggle dice (1-based)
+//   <id> score <cat>    -> ok points 12 total 40 [over]
+//   <id> state          -> ok rolls 2 dice .. held .. scores .. total 40
+//   <id> end            -> ok                   free the game
+//   quit                                        close this connection
+//
+// Categories: ones twos threes fours fives sixes 3kind 4kind fullhouse
+// smstraight lgstraight yahtzee chance (or 0..12). Errors: err <reason>.
+// A seed must be a plain decimal number that fits in 64 bits (else err bad seed).
+// Games belong to the connection that made them and end when it closes.
+// A line over 4096 bytes gets err line too long, and the connection is closed.
+
+#pragma once
+
+#include <cstdint>
+
+// Serves stdin/stdout when socket_path is null, else listens on that Unix
+// socket until killed. Game seeds not given by "new" derive from seed.
+// Returns a process exit code.
+int run_server(const char* socket_path, uint64_t seed);
@@ -0,0 +1,221 @@
+// CL_Yahtzee batch simulation
+
+#include "simulate.h"
+#include "solver.h"
+#include "variant.h"
+
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+const uint64_t CHUNK_GAMES = 1024;
+
+// Per-worker share of the chunks. Each worker drains its own range first, then
+// steals chunks from the front of the other workers' ranges.
+struct WorkRange {
+    std::atomic<uint64_t> next{0};
+    uint64_t end = 0;
+    char pad[64 - sizeof(std::atomic<uint64_t>) - sizeof(uint64_t)]; // one range per cache line
+};
+
+int worker_count(uint64_t games, int threads) {
+    if (threads <= 0) threads = int(std::thread::hardware_concurrency());
+    if (threads <= 0) threads = 1;
+    const uint64_t chunks = (games + CHUNK_GAMES - 1) / CHUNK_GAMES;
+    return uint64_t(threads) > chunks ? int(std::max<uint64_t>(chunks, 1)) : threads;
+}
+
+// Calls play(worker, i) for every game i in [0, games) on `threads` workers.
+template <class Play>
+void for_each_game(uint64_t games, int threads, Play play) {
+    const uint64_t chunks = (games + CHUNK_GAMES - 1) / CHUNK_GAMES;
+    std::vector<WorkRange> ranges(threads);
+    for (int w = 0; w < threads; ++w) {
+        ranges[w].next = chunks * w / threads;
+        ranges[w].end = chunks * (w + 1) / threads;
+    }
+    auto work = [&](int self) {
+        for (int k = 0; k < threads; ++k) {
+            WorkRange& range = ranges[(self + k) % threads];
+            for (uint64_t chunk; (chunk = range.next.fetch_add(1)) < range.end; ) {
+                const uint64_t last = std::min(games, (chunk + 1) * CHUNK_GAMES);
+                for (uint64_t i = chunk * CHUNK_GAMES; i < last; ++i) play(self, i);
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int w = 1; w < threads; ++w) pool.emplace_back(work, w);
+    work(0);
+    for (std::thread& th : pool) th.join();
+}
+
+// Plays games [0, games) of seed with score(dice) giving each final score
+// (0..max_score) and sums them up.
+template <class Score>
+SimulationResult simulate(uint64_t games, int threads, uint64_t seed, int max_score, Score score) {
+    threads = worker_count(games, threads);
+    std::vector<std::vector<uint64_t>> histograms(threads, std::vector<uint64_t>(max_score + 1, 0));
+    for_each_game(games, threads, [&](int worker, uint64_t i) {
+        Rng rng = Rng::stream(seed, i);
+        DiceSource<Rng> dice(rng);
+        histograms[worker][score(dice)]++;
+    });
+
+    // integer counts merge the same way whichever worker played which game
+    SimulationResult result;
+    result.histogram.assign(max_score + 1, 0);
+    for (const std::vector<uint64_t>& h : histograms)
+        for (int s = 0; s <= max_score; ++s) result.histogram[s] += h[s];
+    result.games = games;
+    result.min = max_score;
+    double sum = 0;
+    for (int s = 0; s <= max_score; ++s) {
+        if (!result.histogram[s]) continue;
+        sum += double(result.histogram[s]) * s;
+        result.min = std::min(result.min, s);
+        result.max = std::max(result.max, s);
+    }
+    if (games == 0) { result.min = 0; return result; }
+    result.mean = sum / double(games);
+    double squares = 0;
+    for (int s = 0; s <= max_score; ++s)
+        squares += double(result.histogram[s]) * (s - result.mean) * (s - result.mean);
+    result.variance = games > 1 ? squares / double(games - 1) : 0;
+    return result;
+}
+
+template <class V>
+SimulationResult simulate_greedy_variant(uint64_t games, int threads, uint64_t seed) {
+    return simulate(games, threads, seed, variant_max_score<V>(),
+                    [](DiceSource<Rng>& dice) { return play_greedy_variant<V>(dice); });
+}
+
+} // namespace
+
+SimulationResult simulate_games(uint64_t games, int threads, uint64_t seed, const Strategy& strategy) {
+    return simulate(games, threads, seed, MAX_SCORE,
+                    [&](DiceSource<Rng>& dice) { return grand_total(play_game(strategy, dice)); });
+}
+
+bool simulate_variant(const char* variant, uint64_t games, int threads, uint64_t seed, SimulationResult& result) {
+    const std::string name = variant;
+    if (name == Yatzy::NAME) result = simulate_greedy_variant<Yatzy>(games, threads, seed);
+    else if (name == MaxiYatzy::NAME) result = simulate_greedy_variant<MaxiYatzy>(games, threads, seed);
+    else return false;
+    return true;
+}
+
+void print_simulation(const SimulationResult& result, std::ostream& out) {
+    char line[128];
+    snprintf(line, sizeof(line), "games: %llu\nmean: %.4f\nvariance: %.4f\nmin: %d\nmax: %d\n",
+             (unsigned long long)result.games, result.mean, result.variance, result.min, result.max);
+    out << line;
+
+    // histogram in buckets of 10 points
+    const int BUCKET = 10;
+    std::vector<uint64_t> buckets(result.histogram.size() / BUCKET + 1, 0);
+    uint64_t largest = 1;
+    for (size_t s = 0; s < result.histogram.size(); ++s) buckets[s / BUCKET] += result.histogram[s];
+    for (uint64_t b : buckets) largest = std::max(largest, b);
+    for (int b = 0; b < int(buckets.size()); ++b) {
+        if (b * BUCKET < result.min - result.min % BUCKET || b * BUCKET > result.max) continue;
+        snprintf(line, sizeof(line), "%3d-%3d %10llu ", b * BUCKET, b * BUCKET + BUCKET - 1, (unsigned long long)buckets[b]);
+        out << line << std::string(size_t(50 * buckets[b] / largest), '#') << '\n';
+    }
+}
+
+TournamentResult run_tournament(const std::vector<const Strategy*>& strategies, uint64_t games, int threads, uint64_t seed) {
+    const size_t n = strategies.size();
+    threads = worker_count(games, threads);
+    // exact integer sums per worker, so the result doesn't depend on the thread count
+    struct Tally {
+        std::vector<int64_t> sum, diff_sum;
+        std::vector<uint64_t> squares, diff_squares;
+        std::vector<int> scores;
+    };
+    std::vector<Tally> tallies(threads);
+    for (Tally& t : tallies) {
+        t.sum.assign(n, 0);
+        t.squares.assign(n, 0);
+        t.diff_sum.assign(n * n, 0);
+        t.diff_squares.assign(n * n, 0);
+        t.scores.assign(n, 0);
+    }
+    for_each_game(games, threads, [&](int worker, uint64_t game) {
+        Tally& t = tallies[worker];
+        for (size_t k = 0; k < n; ++k) {
+            const int score = grand_total(play_crn_game(*strategies[k], seed, game));
+            t.scores[k] = score;
+            t.sum[k] += score;
+            t.squares[k] += uint64_t(score * score);
+        }
+        for (size_t a = 0; a < n; ++a)
+            for (size_t b = a + 1; b < n; ++b) {
+                const int64_t d = t.scores[a] - t.scores[b];
+                t.diff_sum[a * n + b] += d;
+                t.diff_squares[a * n + b] += uint64_t(d * d);
+            }
+    });
+
+    std::vector<int64_t> sum(n, 0), diff_sum(n * n, 0);
+    std::vector<uint64_t> squares(n, 0), diff_squares(n * n, 0);
+    for (const Tally& t : tallies) {
+        for (size_t k = 0; k < n; ++k) { sum[k] += t.sum[k]; squares[k] += t.squares[k]; }
+        for (size_t k = 0; k < n * n; ++k) { diff_sum[k] += t.diff_sum[k]; diff_squares[k] += t.diff_squares[k]; }
+    }
+    const double g = double(games);
+    auto variance = [&](int64_t s, uint64_t sq) {
+        return games > 1 ? (double(sq) - double(s) * double(s) / g) / (g - 1) : 0.0;
+    };
+    TournamentResult result;
+    result.games = games;
+    result.diff_mean.assign(n, std::vector<double>(n, 0.0));
+    result.diff_variance.assign(n, std::vector<double>(n, 0.0));
+    for (size_t k = 0; k < n; ++k) {
+        result.names.push_back(strategies[k]->name());
+        result.mean.push_back(games ? double(sum[k]) / g : 0.0);
+        result.variance.push_back(variance(sum[k], squares[k]));
+    }
+    for (size_t a = 0; a < n; ++a)
+        for (size_t b = a + 1; b < n; ++b) {
+            const double mean = games ? double(diff_sum[a * n + b]) / g : 0.0, var = variance(diff_sum[a * n + b], diff_squares[a * n + b]);
+            result.diff_mean[a][b] = mean;
+            result.diff_mean[b][a] = -mean;
+            result.diff_variance[a][b] = result.diff_variance[b][a] = var;
+        }
+    return result;
+}
+
+void print_tournament(const TournamentResult& result, std::ostream& out) {
+    const double g = double(std::max<uint64_t>(result.games, 1));
+    const double Z95 = 1.96;
+    char line[160];
+    snprintf(line, sizeof(line), "games: %llu (common random numbers)\n\n%-10s %10s %10s %10s\n",
+             (unsigned long long)result.games, "strategy", "mean", "95% +-", "std dev");
+    out << line;
+    for (size_t k = 0; k < result.names.size(); ++k) {
+        snprintf(line, sizeof(line), "%-10s %10.3f %10.3f %10.3f\n", result.names[k].c_str(), result.mean[k],
+                 Z95 * std::sqrt(result.variance[k] / g), std::sqrt(result.variance[k]));
+        out << line;
+    }
+    if (result.names.size() < 2) return;
+
+    // "unpaired" is the interval the same games would give on independent dice;
+    // the variance ratio is roughly how many times fewer games pairing needs
+    snprintf(line, sizeof(line), "\n%-21s %10s %10s %12s %10s\n", "paired difference", "mean", "95% +-", "unpaired +-", "var ratio");
+    out << line;
+    for (size_t a = 0; a < result.names.size(); ++a)
+        for (size_t b = a + 1; b < result.names.size(); ++b) {
+            const double var = result.diff_variance[a][b], independent = result.variance[a] + result.variance[b];
+            const std::string pair = result.names[a] + " - " + result.names[b];
+            snprintf(line, sizeof(line), "%-21s %10.3f %10.3f %12.3f %10.1f\n", pair.c_str(), result.diff_mean[a][b],
+                     Z95 * std::sqrt(var / g), Z95 * std::sqrt(independent / g), var > 0 ? independent / var : 0.0);
+            out << line;
+        }
+}
@@ -0,0 +1,41 @@
+// CL_Yahtzee batch simulation
+// Plays many headless games across threads; results depend only on the seed.
+
+#pragma once
+
+#include "yahtzee.h"
+#include "strategy.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct SimulationResult {
+    uint64_t games = 0;
+    std::vector<uint64_t> histogram; // games ending on each final score 0..MAX_SCORE (or the variant's)
+    double mean = 0, variance = 0;
+    int min = 0, max = 0;
+};
+
+// Plays game i with Rng::stream(seed, i) for i in [0, games), spread over
+// threads workers (<= 0: all cores). The result is the same for any thread count.
+SimulationResult simulate_games(uint64_t games, int threads, uint64_t seed, const Strategy& strategy);
+
+// The same for a rule variant from rules.h other than the classic game ("yatzy"
+// or "maxi"), played greedily. Returns false for an unknown variant.
+bool simulate_variant(const char* variant, uint64_t games, int threads, uint64_t seed, SimulationResult& result);
+
+void print_simulation(const SimulationResult& result, std::ostream& out);
+
+struct TournamentResult {
+    uint64_t games = 0;
+    std::vector<std::string> names;
+    std::vector<double> mean, variance;                     // final score per strategy
+    std::vector<std::vector<double>> diff_mean, diff_variance; // [a][b]: score of a minus score of b, per game
+};
+
+// Every strategy plays games [0, games) of seed on the same common random
+// numbers (play_crn_game), so paired differences cancel most of the luck.
+TournamentResult run_tournament(const std::vector<const Strategy*>& strategies, uint64_t games, int threads, uint64_t seed);
+
+void print_tournament(const TournamentResult& result, std::ostream& out);
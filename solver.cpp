@@ -0,0 +1,375 @@
+// CL_Yahtzee optimal solitaire solver
+//
+// Classic backward induction: a state is the set of filled categories, the
+// upper subtotal capped at 63 (all that matters for the 35 point bonus) and
+// whether the Yahtzee box holds 50 (all that matters for the Yahtzee bonus). Within
+// a turn the dice are handled through "keeps", the multiset of held dice; the
+// value of rolling from a keep of n dice is the average over the six faces of
+// the keep with one more die, so no transition tables are needed.
+
+#include "solver.h"
+#include "mapped_file.h"
+#include "reroll.h"
+#include "compact_table.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char SOLVER_MAGIC[8] = { 'C', 'L', 'Y', 'Z', 'E', 'V', '\0', '\0' };
+const uint32_t SOLVER_VERSION = 2;     // 2: Yahtzee bonus and Joker rules
+
+struct SolverFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_states;
+};
+
+struct KeepTables {
+    std::vector<uint16_t> keep_of_key;  // hand key of a multiset -> keep index
+    uint16_t add_face[NUM_KEEPS][7];    // keep with one more die showing face f
+    uint16_t hand_keeps_begin[NUM_HANDS + 1];
+    std::vector<uint16_t> hand_keeps;   // distinct keeps reachable from each hand
+    uint8_t hand_count[NUM_HANDS][7];   // dice showing face f in hand h
+};
+
+// keeps are ordered by size, largest first, so the 252 five-dice keeps share
+// the hand indices and every keep's one-larger neighbours come before it
+void enumerate_keeps(KeepTables& t, std::vector<int>& keys, int size, int min_face, int key) {
+    if (size == 0) { keys.push_back(key); return; }
+    for (int f = min_face; f <= 6; ++f) enumerate_keeps(t, keys, size - 1, f, key + HAND_KEY_WEIGHT[f]);
+}
+
+const KeepTables& keep_tables() {
+    static const KeepTables* tables = [] {
+        KeepTables* t = new KeepTables();
+        std::vector<int> keys;
+        for (int h = 0; h < NUM_HANDS; ++h) {
+            int key = 0;
+            for (int i = 0; i < NUM_DICE; ++i) key += HAND_KEY_WEIGHT[HAND_TABLES.dice[h][i]];
+            keys.push_back(key);
+        }
+        for (int size = NUM_DICE - 1; size >= 0; --size) enumerate_keeps(*t, keys, size, 1, 0);
+
+        t->keep_of_key.assign(NUM_HAND_KEYS, 0);
+        for (int k = 0; k < NUM_KEEPS; ++k) t->keep_of_key[keys[k]] = uint16_t(k);
+        for (int k = NUM_HANDS; k < NUM_KEEPS; ++k)
+            for (int f = 1; f <= 6; ++f) t->add_face[k][f] = t->keep_of_key[keys[k] + HAND_KEY_WEIGHT[f]];
+
+        for (int h = 0; h < NUM_HANDS; ++h) {
+            t->hand_keeps_begin[h] = uint16_t(t->hand_keeps.size());
+            for (int mask = 0; mask < (1 << NUM_DICE); ++mask) {
+                int key = 0;
+                for (int i = 0; i < NUM_DICE; ++i)
+                    if ((mask >> i) & 1) key += HAND_KEY_WEIGHT[HAND_TABLES.dice[h][i]];
+                const int k = t->keep_of_key[key];
+                bool seen = false;
+                for (size_t i = t->hand_keeps_begin[h]; i < t->hand_keeps.size(); ++i) seen |= t->hand_keeps[i] == k;
+                if (!seen) t->hand_keeps.push_back(uint16_t(k));
+            }
+            for (int f = 1; f <= 6; ++f) t->hand_count[h][f] = 0;
+            for (int i = 0; i < NUM_DICE; ++i) t->hand_count[h][HAND_TABLES.dice[h][i]]++;
+        }
+        t->hand_keeps_begin[NUM_HANDS] = uint16_t(t->hand_keeps.size());
+        return t;
+    }();
+    return *tables;
+}
+
+// reachable[u][up]: can the upper categories in u (6-bit mask) add up to up (capped)?
+struct UpperReach {
+    bool reachable[1 << 6][UPPER_STATES];
+    UpperReach() : reachable() {
+        reachable[0][0] = true;
+        for (int u = 1; u < (1 << 6); ++u) {
+            int c = 0;
+            while (!((u >> c) & 1)) ++c;
+            const int rest = u & ~(1 << c);
+            for (int up = 0; up < UPPER_STATES; ++up) {
+                if (!reachable[rest][up]) continue;
+                for (int n = 0; n <= NUM_DICE; ++n) {
+                    const int next = up + n * (c + 1);
+                    reachable[u][next < UPPER_BONUS_THRESHOLD ? next : UPPER_BONUS_THRESHOLD] = true;
+                }
+            }
+        }
+    }
+};
+
+StateValues g_table;
+
+} // namespace
+
+int keep_index(const uint8_t dice[NUM_DICE], uint8_t hold_mask) {
+    int key = 0;
+    for (int i = 0; i < NUM_DICE; ++i)
+        if ((hold_mask >> i) & 1) key += HAND_KEY_WEIGHT[dice[i]];
+    return keep_tables().keep_of_key[key];
+}
+
+float score_value(const StateValues& ev_table, const SolverState& s, Category c, int points) {
+    int bonus;
+    const SolverState next = next_state(s, c, points, bonus);
+    return float(points + bonus) + ev_table[state_index(next)];
+}
+
+namespace {
+
+// Best value of ending a turn of s on hand, over the categories it may go in.
+float best_score_value(const StateValues& ev_table, const SolverState& s, int hand, Category& best) {
+    const uint16_t allowed = scorable_categories(s.filled, hand);
+    float best_value = -1.0f;
+    best = NUM_CATEGORIES;
+    for (int c = 0; c < NUM_CATEGORIES; ++c) {
+        if (!((allowed >> c) & 1)) continue;
+        const float v = score_value(ev_table, s, Category(c), hand_points(s.filled, hand, Category(c)));
+        if (v > best_value) { best_value = v; best = Category(c); }
+    }
+    return best_value + float(hand_bonus(s, hand));
+}
+
+} // namespace
+
+void compute_turn_values(const StateValues& ev_table, const SolverState& s, TurnValues& tv) {
+    const KeepTables& t = keep_tables();
+    const uint16_t filled = s.filled;
+
+    // value of scoring into each open category, per upper count of that face
+    float upper_value[6][NUM_DICE + 1];
+    for (int c = ONES; c <= SIXES; ++c)
+        if (!((filled >> c) & 1))
+            for (int n = 0; n <= NUM_DICE; ++n)
+                upper_value[c][n] = score_value(ev_table, s, Category(c), n * (c + 1));
+    // a lower category leads to the same state whatever it scores (bar a 50 in
+    // Yahtzee, which only Yahtzee hands score: they are valued on their own)
+    float lower_next[NUM_CATEGORIES];
+    for (int c = THREE_OF_A_KIND; c <= CHANCE; ++c)
+        if (!((filled >> c) & 1)) lower_next[c] = score_value(ev_table, s, Category(c), 0);
+
+    // no rolls left: pick the best category
+    for (int h = 0; h < NUM_HANDS; ++h) {
+        if (is_yahtzee_hand(h)) {
+            Category c;
+            tv.hand[0][h] = best_score_value(ev_table, s, h, c); // Joker rules and the bonus
+            continue;
+        }
+        const uint8_t* scores = hand_scores(h);
+        float best = -1.0f;
+        for (int c = ONES; c <= SIXES; ++c)
+            if (!((filled >> c) & 1) && upper_value[c][t.hand_count[h][c + 1]] > best)
+                best = upper_value[c][t.hand_count[h][c + 1]];
+        for (int c = THREE_OF_A_KIND; c <= CHANCE; ++c)
+            if (!((filled >> c) & 1) && scores[c] + lower_next[c] > best)
+                best = scores[c] + lower_next[c];
+        tv.hand[0][h] = best;
+    }
+
+    for (int r = 1; r <= ROLLS_PER_TURN; ++r) {
+        // keeping all five dice is the same as the hand; each smaller keep averages over one more die
+        float* keep = tv.keep[r - 1];
+        std::memcpy(keep, tv.hand[r - 1], sizeof(float) * NUM_HANDS);
+        for (int k = NUM_HANDS; k < NUM_KEEPS; ++k) {
+            const uint16_t* next = t.add_face[k];
+            keep[k] = (keep[next[1]] + keep[next[2]] + keep[next[3]] +
+                       keep[next[4]] + keep[next[5]] + keep[next[6]]) * (1.0f / 6.0f);
+        }
+        if (r == ROLLS_PER_TURN) break;
+        for (int h = 0; h < NUM_HANDS; ++h) {
+            float best = 0.0f;
+            for (int i = t.hand_keeps_begin[h]; i < t.hand_keeps_begin[h + 1]; ++i)
+                if (keep[t.hand_keeps[i]] > best) best = keep[t.hand_keeps[i]];
+            tv.hand[r][h] = best;
+        }
+    }
+    tv.start = tv.keep[ROLLS_PER_TURN - 1][NUM_KEEPS - 1];
+}
+
+Category best_category(const GameState& g) {
+    if (!has_rolled(g)) return NUM_CATEGORIES;
+    return best_category_for_hand(g_table, solver_state(g), g.hand);
+}
+
+uint8_t best_hold(const TurnValues& tv, const GameState& g) {
+    // holding everything is the same as not rolling again, so it wins ties
+    const float* keep = tv.keep[g.rolls - 1];
+    uint8_t best = (1 << NUM_DICE) - 1;
+    float best_value = keep[keep_index(g.dice, best)];
+    for (int mask = best - 1; mask >= 0; --mask) {
+        const float v = keep[keep_index(g.dice, uint8_t(mask))];
+        if (v > best_value) { best_value = v; best = uint8_t(mask); }
+    }
+    return best;
+}
+
+const TurnValues& cached_turn_values(const SolverState& s) {
+    const int CACHE_SIZE = 4;
+    thread_local TurnValues cache[CACHE_SIZE];
+    thread_local int keys[CACHE_SIZE] = { -1, -1, -1, -1 };
+    thread_local int next_slot = 0;
+    const int key = state_index(s);
+    for (int i = 0; i < CACHE_SIZE; ++i)
+        if (keys[i] == key) return cache[i];
+    const int slot = next_slot;
+    next_slot = (next_slot + 1) % CACHE_SIZE;
+    compute_turn_values(g_table, s, cache[slot]);
+    keys[slot] = key;
+    return cache[slot];
+}
+
+Category best_category_for_hand(const StateValues& ev_table, const SolverState& s, int hand) {
+    Category best;
+    best_score_value(ev_table, s, hand, best);
+    return best;
+}
+
+void final_hand_odds(const TurnValues& tv, int hand, int rolls, float odds[NUM_HANDS]) {
+    const KeepTables& t = keep_tables();
+    // the forward mirror of compute_turn_values: a keep's probability passes a
+    // sixth to each keep with one more die, down to the five-dice keeps (hands)
+    auto roll_keeps = [&](float* mass) {
+        for (int k = NUM_KEEPS - 1; k >= NUM_HANDS; --k) {
+            if (mass[k] == 0.0f) continue;
+            const float share = mass[k] * (1.0f / 6.0f);
+            for (int f = 1; f <= 6; ++f) mass[t.add_face[k][f]] += share;
+            mass[k] = 0.0f;
+        }
+    };
+    float mass[NUM_KEEPS] = {};
+    if (hand < 0) {
+        mass[NUM_KEEPS - 1] = 1.0f;
+        roll_keeps(mass);
+        rolls = ROLLS_PER_TURN - 1;
+    } else {
+        mass[hand] = 1.0f;
+    }
+    for (int r = rolls; r > 0; --r) {
+        const float* keep = tv.keep[r - 1];
+        float next[NUM_KEEPS] = {};
+        for (int h = 0; h < NUM_HANDS; ++h) {
+            if (mass[h] == 0.0f) continue;
+            int best = h; // keeping the whole hand wins ties, as in best_hold
+            for (int i = t.hand_keeps_begin[h]; i < t.hand_keeps_begin[h + 1]; ++i)
+                if (keep[t.hand_keeps[i]] > keep[best]) best = t.hand_keeps[i];
+            next[best] += mass[h];
+        }
+        roll_keeps(next);
+        std::memcpy(mass, next, sizeof(mass));
+    }
+    std::memcpy(odds, mass, sizeof(float) * NUM_HANDS);
+}
+
+bool upper_reachable(uint16_t filled, int up) {
+    static const UpperReach reach;
+    return reach.reachable[filled & UPPER_MASK][up];
+}
+
+int advise_holds(const GameState& g, HoldAdvice* out, int max) {
+    if (!g_table || !has_rolled(g) || g.rolls == 0 || game_over(g)) return 0;
+    // each hold is one dot product of its reroll row with the next roll's hand
+    // values; holding all five is scoring now, the hand's value with no rolls left
+    const TurnValues& tv = cached_turn_values(solver_state(g));
+    const float* hand = tv.hand[g.rolls - 1];
+    const float total = float(grand_total(g));
+    const int keep_all = keep_index(g.dice, uint8_t((1 << NUM_DICE) - 1));
+
+    // one entry per distinct keep; masks run from "hold all" down so ties favour holding more
+    HoldAdvice choices[1 << NUM_DICE];
+    int seen_keeps[1 << NUM_DICE];
+    int count = 0;
+    for (int mask = (1 << NUM_DICE) - 1; mask >= 0; --mask) {
+        const int k = keep_index(g.dice, uint8_t(mask));
+        bool seen = false;
+        for (int i = 0; i < count; ++i) seen |= seen_keeps[i] == k;
+        if (seen) continue;
+        seen_keeps[count] = k;
+        const float ev = k == keep_all ? tv.hand[0][g.hand] : keep_ev(k, hand);
+        choices[count++] = HoldAdvice{ uint8_t(mask), total + ev };
+    }
+    std::stable_sort(choices, choices + count,
+                     [](const HoldAdvice& a, const HoldAdvice& b) { return a.ev > b.ev; });
+    if (count > max) count = max;
+    std::copy(choices, choices + count, out);
+    return count;
+}
+
+bool build_solver_table(const char* path, int threads) {
+    if (threads <= 0) threads = int(std::thread::hardware_concurrency());
+    if (threads <= 0) threads = 1;
+
+    static const UpperReach reach;
+    std::vector<float> ev(NUM_STATES, 0.0f);
+    keep_tables();
+
+    // a state only depends on states with one more category filled, so each
+    // layer of equal popcount is solved in parallel once the next one is done
+    for (int layer = NUM_CATEGORIES - 1; layer >= 0; --layer) {
+        std::vector<uint16_t> masks;
+        for (int m = 0; m < (1 << NUM_CATEGORIES); ++m)
+            if (popcount(m) == layer) masks.push_back(uint16_t(m));
+
+        std::atomic<size_t> next(0);
+        auto work = [&] {
+            TurnValues* tv = new TurnValues;
+            for (size_t i; (i = next.fetch_add(1)) < masks.size(); ) {
+                SolverState s;
+                s.filled = masks[i];
+                for (s.up = 0; s.up < UPPER_STATES; ++s.up) {
+                    if (!reach.reachable[s.filled & UPPER_MASK][s.up]) continue;
+                    for (int flag = 0; flag <= ((s.filled >> YAHTZEE) & 1); ++flag) {
+                        s.yahtzee50 = flag != 0;
+                        compute_turn_values(ev.data(), s, *tv);
+                        ev[state_index(s)] = tv->start;
+                    }
+                }
+            }
+            delete tv;
+        };
+        std::vector<std::thread> pool;
+        for (int i = 1; i < threads; ++i) pool.emplace_back(work);
+        work();
+        for (std::thread& th : pool) th.join();
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    SolverFileHeader header;
+    std::memcpy(header.magic, SOLVER_MAGIC, sizeof(header.magic));
+    header.version = SOLVER_VERSION;
+    header.num_states = NUM_STATES;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(ev.data(), sizeof(float), ev.size(), f) == ev.size();
+    ok = fclose(f) == 0 && ok;
+    return ok;
+}
+
+bool load_solver_table(const char* path) {
+    size_t size = 0;
+    const void* data = map_file(path, size);
+    if (!data) return false;
+    const SolverFileHeader* header = static_cast<const SolverFileHeader*>(data);
+    if (size != sizeof(SolverFileHeader) + sizeof(float) * NUM_STATES ||
+        std::memcmp(header->magic, SOLVER_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != SOLVER_VERSION || header->num_states != NUM_STATES) {
+        unmap_file(data, size);
+        // not a full table: maybe a compact one
+        const CompactTable* compact = open_compact_table(path);
+        if (!compact) return false;
+        g_table = StateValues(compact);
+        return true;
+    }
+    g_table = StateValues(reinterpret_cast<const float*>(header + 1));
+    return true;
+}
+
+bool solver_loaded() { return bool(g_table); }
+
+const StateValues& solver_table() { return g_table; }
+
+float state_ev(const SolverState& s) {
+    return g_table ? g_table[state_index(s)] : 0.0f;
+}
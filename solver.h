@@ -0,0 +1,153 @@
+// CL_Yahtzee optimal solitaire solver
+// Expected final score under optimal play, for every state a game can be in
+// between turns: filled categories, upper subtotal and whether the Yahtzee box holds 50.
+
+#pragma once
+
+#include "yahtzee.h"
+
+const int UPPER_STATES = UPPER_BONUS_THRESHOLD + 1;     // upper subtotal capped at 63
+const int NUM_KEEPS = 462;                              // multisets of 0..5 dice
+const char* const DEFAULT_SOLVER_TABLE = "cl_yahtzee.ev";
+
+inline int capped_upper(const GameState& g) {
+    const int up = upper_subtotal(g);
+    return up < UPPER_BONUS_THRESHOLD ? up : UPPER_BONUS_THRESHOLD;
+}
+
+// All the rest of a game depends on between turns. yahtzee50 (the Yahtzee box
+// holds 50, so further Yahtzees earn the bonus) can only be set once it's filled.
+struct SolverState {
+    uint16_t filled = 0;
+    int up = 0;
+    bool yahtzee50 = false;
+};
+
+inline SolverState solver_state(const GameState& g) {
+    SolverState s;
+    s.filled = g.filled;
+    s.up = capped_upper(g);
+    s.yahtzee50 = yahtzee_scored_50(g);
+    return s;
+}
+
+// Dense state index: states without the flag at filled * 64 + up, then the
+// ones with it, whose filled mask drops the (always set) Yahtzee bit. Half
+// again the states of a game without the bonus, not twice.
+const int FLAGGED_STATES = (1 << (NUM_CATEGORIES - 1)) * UPPER_STATES;
+const int NUM_STATES = (1 << NUM_CATEGORIES) * UPPER_STATES + FLAGGED_STATES;
+
+inline int state_index(const SolverState& s) {
+    if (!s.yahtzee50) return s.filled * UPPER_STATES + s.up;
+    const int low = s.filled & ((1u << YAHTZEE) - 1);
+    const int high = s.filled >> (YAHTZEE + 1);
+    return (1 << NUM_CATEGORIES) * UPPER_STATES + ((high << YAHTZEE) | low) * UPPER_STATES + s.up;
+}
+
+inline SolverState state_at(int index) {
+    SolverState s;
+    const int flagged = index - (1 << NUM_CATEGORIES) * UPPER_STATES;
+    s.yahtzee50 = flagged >= 0;
+    if (s.yahtzee50) index = flagged;
+    s.up = index % UPPER_STATES;
+    int filled = index / UPPER_STATES;
+    if (s.yahtzee50) filled = ((filled >> YAHTZEE) << (YAHTZEE + 1)) | (1 << YAHTZEE) | (filled & ((1 << YAHTZEE) - 1));
+    s.filled = uint16_t(filled);
+    return s;
+}
+
+// The state after scoring points into c from s (Joker or not), and the upper bonus that earns.
+inline SolverState next_state(const SolverState& s, Category c, int points, int& bonus) {
+    SolverState next = s;
+    next.filled = uint16_t(s.filled | (1u << c));
+    bonus = 0;
+    if (c <= SIXES) {
+        next.up = s.up + points;
+        if (next.up >= UPPER_BONUS_THRESHOLD) {
+            if (s.up < UPPER_BONUS_THRESHOLD) bonus = UPPER_BONUS;
+            next.up = UPPER_BONUS_THRESHOLD;
+        }
+    } else if (c == YAHTZEE) {
+        next.yahtzee50 = points == 50;
+    }
+    return next;
+}
+
+// Yahtzee bonus for ending a turn of s on hand.
+inline int hand_bonus(const SolverState& s, int hand) {
+    return s.yahtzee50 && is_yahtzee_hand(hand) ? YAHTZEE_BONUS : 0;
+}
+
+// Per-turn sub-states of one (filled, upper) state. Values are expected points
+// still to come from this turn on (current scorecard total excluded).
+struct TurnValues {
+    float hand[ROLLS_PER_TURN][NUM_HANDS]; // hand[r][h]: hand h showing with r rolls left
+    float keep[ROLLS_PER_TURN][NUM_KEEPS]; // keep[r][k]: keeping k, then rolling with r rolls left after
+    float start;                           // before the first roll
+};
+
+// Expected points still to come from the start of a turn, per state_index: a
+// full table of floats (as built, or mapped from a file), or a compact one
+// (compact_table.h) read through its block cache.
+class CompactTable;
+float compact_value(const CompactTable& table, int index);
+struct StateValues {
+    const float* flat = nullptr;
+    const CompactTable* compact = nullptr;
+
+    StateValues() = default;
+    StateValues(const float* table) : flat(table) {}
+    StateValues(const CompactTable* table) : compact(table) {}
+    explicit operator bool() const { return flat || compact; }
+    float operator[](int index) const { return flat ? flat[index] : compact_value(*compact, index); }
+};
+
+// Solves every state and writes the table to path. threads <= 0 uses all cores.
+bool build_solver_table(const char* path, int threads = 0);
+
+// Memory-maps a table written by build_solver_table or build_compact_table.
+// Returns false if missing or invalid.
+bool load_solver_table(const char* path = DEFAULT_SOLVER_TABLE);
+bool solver_loaded();
+
+// Expected points still to come from the start of a turn in state s.
+float state_ev(const SolverState& s);
+
+// Fills tv for one state from the loaded table (or any table with the same layout).
+void compute_turn_values(const StateValues& ev_table, const SolverState& s, TurnValues& tv);
+const StateValues& solver_table();
+
+// Value of scoring points into c from s: the points, any upper bonus they earn
+// and the expected points of the resulting state (not the Yahtzee bonus).
+float score_value(const StateValues& ev_table, const SolverState& s, Category c, int points);
+
+// Optimal decisions for the current turn of g, using the loaded table. tv must
+// hold the turn values of solver_state(g).
+Category best_category(const GameState& g);
+uint8_t best_hold(const TurnValues& tv, const GameState& g);
+
+// Turn values of s from the loaded table, computed once and kept in a small
+// per-thread cache (the UI asks again on every redraw of a turn).
+const TurnValues& cached_turn_values(const SolverState& s);
+
+struct HoldAdvice {
+    uint8_t mask;   // dice to hold (all five: stop rolling and score)
+    float ev;       // expected final score, current total included
+};
+
+// Best hold choices for g's dice with rerolls left, best first, one per distinct
+// set of kept dice. Returns how many were written (at most max).
+int advise_holds(const GameState& g, HoldAdvice* out, int max);
+
+// Optimal category for ending a turn of s on hand (same choice as best_category).
+Category best_category_for_hand(const StateValues& ev_table, const SolverState& s, int hand);
+
+// Probability of the turn ending on each hand when every hold is optimal, from
+// hand `hand` with `rolls` rolls left, or from before the first roll if hand < 0.
+void final_hand_odds(const TurnValues& tv, int hand, int rolls, float odds[NUM_HANDS]);
+
+// Can the filled upper categories add up to up (capped at 63)?
+bool upper_reachable(uint16_t filled, int up);
+
+// Keep multisets: index of the dice held under hold_mask, from their face counts.
+int keep_index(const uint8_t dice[NUM_DICE], uint8_t hold_mask);
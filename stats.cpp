@@ -0,0 +1,180 @@
+// CL_Yahtzee game statistics
+
+#include "stats.h"
+#include "mapped_file.h"
+#include "raw_file.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const char LOG_MAGIC[8] = { 'C', 'L', 'Y', 'Z', 'G', 'L', '\0', '\0' };
+const char INDEX_MAGIC[8] = { 'C', 'L', 'Y', 'Z', 'G', 'I', '\0', '\0' };
+const uint32_t STATS_VERSION = 1;
+
+struct LogFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+};
+
+struct IndexFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t checksum;                  // of the summary that follows
+};
+
+bool record_valid(const GameRecord& r) {
+    return r.checksum == checksum(&r, offsetof(GameRecord, checksum));
+}
+
+void fold(StatsSummary& sum, const GameRecord& r, uint64_t index) {
+    sum.games = index + 1;
+    sum.total_sum += r.total;
+    for (int c = 0; c < NUM_CATEGORIES; ++c) sum.category_sum[c] += r.score[c];
+    sum.upper_bonuses += r.upper_bonus ? 1 : 0;
+    sum.yahtzee_bonuses += r.yahtzee_bonuses;
+    if (index == 0 || r.total > sum.best) { sum.best = r.total; sum.best_record = index; }
+    sum.histogram[r.total <= MAX_SCORE ? r.total : MAX_SCORE]++;
+}
+
+} // namespace
+
+GameRecord make_game_record(const GameState& g, uint64_t seed, uint64_t timestamp) {
+    GameRecord r;
+    std::memset(&r, 0, sizeof(r));
+    r.timestamp = timestamp;
+    r.seed = seed;
+    r.total = uint16_t(grand_total(g));
+    r.upper_bonus = uint8_t(upper_bonus(g));
+    r.yahtzee_bonuses = g.yahtzee_bonuses;
+    std::memcpy(r.score, g.score, sizeof(r.score));
+    r.checksum = checksum(&r, offsetof(GameRecord, checksum));
+    return r;
+}
+
+bool StatsStore::open(const char* path) {
+    log_path.clear();
+    std::memset(&sum, 0, sizeof(sum));
+    int fd = open_file(path, true);
+    if (fd < 0) return false;
+
+    // a new log gets its header; an old one loses any torn record at the end
+    LogFileHeader header;
+    const int64_t size = file_size(fd);
+    uint64_t records = 0;
+    bool ok = size >= 0;
+    if (ok && size < int64_t(sizeof(header))) {
+        std::memcpy(header.magic, LOG_MAGIC, sizeof(header.magic));
+        header.version = STATS_VERSION;
+        header.record_size = sizeof(GameRecord);
+        ok = truncate_file(fd, 0) && write_at(fd, &header, sizeof(header), 0) && sync_file(fd);
+    } else if (ok) {
+        ok = read_at(fd, &header, sizeof(header), 0) &&
+             std::memcmp(header.magic, LOG_MAGIC, sizeof(header.magic)) == 0 &&
+             header.version == STATS_VERSION && header.record_size == sizeof(GameRecord);
+        records = uint64_t(size - int64_t(sizeof(header))) / sizeof(GameRecord);
+        GameRecord last;
+        if (ok && records > 0 && (!read_at(fd, &last, sizeof(last), sizeof(header) + (records - 1) * sizeof(GameRecord)) ||
+                                  !record_valid(last)))
+            records--;
+        const uint64_t whole = sizeof(header) + records * sizeof(GameRecord);
+        if (ok && uint64_t(size) != whole) ok = truncate_file(fd, whole) && sync_file(fd);
+    }
+    if (!ok) { close_file(fd); return false; }
+    log_path = path;
+    index_path = log_path + ".idx";
+
+    // start from the index if it checks out and the log still has everything it covers
+    size_t index_size = 0;
+    const void* data = map_file(index_path.c_str(), index_size);
+    if (data) {
+        const IndexFileHeader* index = static_cast<const IndexFileHeader*>(data);
+        const StatsSummary* stored = reinterpret_cast<const StatsSummary*>(index + 1);
+        if (index_size == sizeof(IndexFileHeader) + sizeof(StatsSummary) &&
+            std::memcmp(index->magic, INDEX_MAGIC, sizeof(index->magic)) == 0 && index->version == STATS_VERSION &&
+            index->checksum == checksum(stored, sizeof(StatsSummary)) && stored->games <= records)
+            std::memcpy(&sum, stored, sizeof(sum));
+        unmap_file(data, index_size);
+    }
+
+    // fold in what the index misses (everything, if it was missing or damaged)
+    const bool behind = sum.games < records;
+    std::vector<GameRecord> chunk(4096);
+    while (ok && sum.games < records) {
+        const size_t n = size_t(std::min<uint64_t>(chunk.size(), records - sum.games));
+        ok = read_at(fd, chunk.data(), n * sizeof(GameRecord), sizeof(header) + sum.games * sizeof(GameRecord));
+        for (size_t i = 0; ok && i < n; ++i) fold(sum, chunk[i], sum.games);
+    }
+    close_file(fd);
+    if (!ok) { log_path.clear(); return false; }
+    if (behind) write_index();
+    return true;
+}
+
+bool StatsStore::append(const GameRecord& record) {
+    if (log_path.empty()) return false;
+    int fd = open_file(log_path.c_str(), false);
+    if (fd < 0) return false;
+    // the log is synced before the index, so the index never covers a record that isn't on disk
+    const bool ok = write_at(fd, &record, sizeof(record), sizeof(LogFileHeader) + sum.games * sizeof(GameRecord)) &&
+                    sync_file(fd);
+    close_file(fd);
+    if (!ok) return false;
+    fold(sum, record, sum.games);
+    return write_index();
+}
+
+bool StatsStore::write_index() const {
+    // written aside and renamed over the old one: a crash leaves one or the
+    // other whole, and an old index is caught up from the log on open
+    IndexFileHeader header;
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+    header.version = STATS_VERSION;
+    header.checksum = checksum(&sum, sizeof(sum));
+    const std::string tmp = index_path + ".tmp";
+    int fd = open_file(tmp.c_str(), true);
+    if (fd < 0) return false;
+    bool ok = truncate_file(fd, 0) && write_at(fd, &header, sizeof(header), 0) &&
+              write_at(fd, &sum, sizeof(sum), sizeof(header)) && sync_file(fd);
+    ok = close_file(fd) == 0 && ok;
+    return ok && replace_file(tmp.c_str(), index_path.c_str());
+}
+
+bool StatsStore::read(uint64_t i, GameRecord& out) const {
+    if (log_path.empty()) return false;
+    int fd = open_file(log_path.c_str(), false);
+    if (fd < 0) return false;
+    const bool ok = read_at(fd, &out, sizeof(out), sizeof(LogFileHeader) + i * sizeof(GameRecord)) && record_valid(out);
+    close_file(fd);
+    return ok;
+}
+
+double StatsStore::average() const {
+    return sum.games ? double(sum.total_sum) / double(sum.games) : 0.0;
+}
+
+double StatsStore::category_average(Category c) const {
+    return sum.games ? double(sum.category_sum[c]) / double(sum.games) : 0.0;
+}
+
+double StatsStore::fraction_below(int score) const {
+    if (!sum.games) return 0.0;
+    uint64_t below = 0;
+    for (int s = 0; s < score && s <= MAX_SCORE; ++s) below += sum.histogram[s];
+    return double(below) / double(sum.games);
+}
+
+int StatsStore::percentile(double p) const {
+    if (!sum.games) return 0;
+    const double target = p * double(sum.games);
+    uint64_t seen = 0;
+    for (int s = 0; s <= MAX_SCORE; ++s) {
+        seen += sum.histogram[s];
+        if (double(seen) >= target && seen > 0) return s;
+    }
+    return MAX_SCORE;
+}
@@ -0,0 +1,75 @@
+// CL_Yahtzee game statistics
+// Every finished game is appended to a log of fixed-size records (scores,
+// bonuses, total, time and dice seed). Next to it, a summary index (game
+// count, running histogram of totals, per-category sums) answers best,
+// average and percentile queries at startup without reading the log.
+//
+// Crash safety: a record is written with one call and synced, and carries a
+// checksum, so a torn last record is detected and cut off on the next open.
+// The index is rewritten to a temporary file and renamed over the old one,
+// and records how many log records it covers: whatever the log has beyond
+// that is folded in on open, and a missing or damaged index is rebuilt.
+
+#pragma once
+
+#include "yahtzee.h"
+
+#include <string>
+
+const char* const DEFAULT_STATS_LOG = "cl_yahtzee.games";
+
+struct GameRecord {
+    uint64_t timestamp;                 // seconds since the Unix epoch
+    uint64_t seed;                      // dice seed (as in the replay log)
+    uint16_t total;
+    uint8_t upper_bonus;
+    uint8_t yahtzee_bonuses;
+    uint8_t score[NUM_CATEGORIES];
+    uint8_t reserved[3];
+    uint32_t checksum;                  // of everything above
+};
+static_assert(sizeof(GameRecord) == 40, "records are written as is");
+
+// What the index holds: everything the queries need.
+struct StatsSummary {
+    uint64_t games;                     // log records folded in
+    uint64_t total_sum;
+    uint64_t category_sum[NUM_CATEGORIES];
+    uint64_t upper_bonuses;             // games that earned the upper bonus
+    uint64_t yahtzee_bonuses;
+    uint32_t best;                      // best total, and the record that scored it
+    uint32_t reserved;
+    uint64_t best_record;
+    uint64_t histogram[MAX_SCORE + 1];  // games ending on each total
+};
+
+GameRecord make_game_record(const GameState& g, uint64_t seed, uint64_t timestamp);
+
+class StatsStore {
+public:
+    // Opens (or creates) the log and its index (log path + ".idx"), cutting
+    // off a torn last record and bringing the index up to date.
+    bool open(const char* log_path = DEFAULT_STATS_LOG);
+    bool is_open() const { return !log_path.empty(); }
+
+    // Appends a finished game and updates the index. Both are synced before it returns.
+    bool append(const GameRecord& record);
+
+    const StatsSummary& summary() const { return sum; }
+    uint64_t games() const { return sum.games; }
+    int best() const { return int(sum.best); }
+    double average() const;
+    double category_average(Category c) const;
+    // Share of games (0..1) with a total below score.
+    double fraction_below(int score) const;
+    // Lowest total at least a fraction p of the games reach or stay under.
+    int percentile(double p) const;
+
+    // Reads record i back from the log.
+    bool read(uint64_t i, GameRecord& out) const;
+
+private:
+    bool write_index() const;
+    std::string log_path, index_path;
+    StatsSummary sum{};
+};
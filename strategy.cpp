@@ -0,0 +1,243 @@
+// CL_Yahtzee strategies
+
+#include "strategy.h"
+#include "solver.h"
+#include "reroll.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// Most common face (highest on ties) and how many dice show it.
+int most_common_face(const GameState& g, int& count) {
+    int counts[7] = {};
+    for (int i = 0; i < NUM_DICE; ++i) counts[g.dice[i]]++;
+    int face = 6;
+    for (int v = 5; v >= 1; --v) if (counts[v] > counts[face]) face = v;
+    count = counts[face];
+    return face;
+}
+
+uint8_t hold_face(const GameState& g, int face) {
+    uint8_t mask = 0;
+    for (int i = 0; i < NUM_DICE; ++i) if (g.dice[i] == face) mask |= uint8_t(1u << i);
+    return mask;
+}
+
+Category most_points(const GameState& g, uint16_t allowed) {
+    Category best = NUM_CATEGORIES;
+    int best_points = -1;
+    for (int c = 0; c < NUM_CATEGORIES; ++c) {
+        if (!((allowed >> c) & 1)) continue;
+        const int points = potential_score(g, Category(c));
+        if (points > best_points) { best_points = points; best = Category(c); }
+    }
+    return best;
+}
+
+// Greedy: keep the most common face and take the most points now.
+class GreedyStrategy : public Strategy {
+public:
+    const char* name() const override { return "greedy"; }
+    uint8_t choose_hold(const GameState& g) const override {
+        int count;
+        return hold_face(g, most_common_face(g, count));
+    }
+    Category choose_category(const GameState& g) const override { return most_points(g, legal_categories(g)); }
+};
+
+// Greedy, but collects open upper faces before anything else: it holds any
+// open face showing a pair or more, and scores it once there are three or more
+// (the pace for the bonus). Zeros go into the least valuable open slot.
+class UpperBonusStrategy : public Strategy {
+public:
+    const char* name() const override { return "upper"; }
+    uint8_t choose_hold(const GameState& g) const override {
+        int counts[7] = {};
+        for (int i = 0; i < NUM_DICE; ++i) counts[g.dice[i]]++;
+        int face = 0;
+        for (int v = 6; v >= 1; --v)
+            if (!is_filled(g, Category(v - 1)) && counts[v] >= 2 && (!face || counts[v] > counts[face])) face = v;
+        if (face) return hold_face(g, face);
+        int count;
+        return hold_face(g, most_common_face(g, count));
+    }
+    Category choose_category(const GameState& g) const override {
+        const uint16_t legal = legal_categories(g);
+        int counts[7] = {};
+        for (int i = 0; i < NUM_DICE; ++i) counts[g.dice[i]]++;
+        for (int v = 6; v >= 1; --v)
+            if (((legal >> (v - 1)) & 1) && counts[v] >= 3) return Category(v - 1);
+        const Category best = most_points(g, legal);
+        if (potential_score(g, best) > 0) return best;
+        // nothing scores: give up the cheapest slot still open
+        static const Category DUMP_ORDER[NUM_CATEGORIES] = {
+            ONES, YAHTZEE, TWOS, FOUR_OF_A_KIND, LRG_STRAIGHT, THREES, FULL_HOUSE,
+            SML_STRAIGHT, THREE_OF_A_KIND, FOURS, FIVES, SIXES, CHANCE
+        };
+        for (Category c : DUMP_ORDER) if ((legal >> c) & 1) return c;
+        return best;
+    }
+};
+
+// Optimal: maximizes expected final score using the solver table.
+class OptimalStrategy : public Strategy {
+public:
+    const char* name() const override { return "optimal"; }
+    uint8_t choose_hold(const GameState& g) const override {
+        return best_hold(cached_turn_values(solver_state(g)), g);
+    }
+    Category choose_category(const GameState& g) const override { return best_category(g); }
+};
+
+// What each category is worth on average over a well played game: scoring
+// below par there costs points later.
+const float CATEGORY_PAR[NUM_CATEGORIES] = { 2, 5, 8.5f, 12, 15.5f, 19, 21.5f, 13, 22.5f, 29.5f, 32.5f, 17, 22 };
+
+// Heuristic value of ending the turn on hand in c: points over par, plus the
+// upper bonus if it's earned now, or credit for being ahead of (or behind)
+// three of each face otherwise.
+float category_value(const SolverState& s, int hand, Category c) {
+    const int points = hand_points(s.filled, hand, c);
+    float value = float(points) - CATEGORY_PAR[c];
+    if (c <= SIXES && s.up < UPPER_BONUS_THRESHOLD) {
+        if (s.up + points >= UPPER_BONUS_THRESHOLD) value += UPPER_BONUS;
+        else value += 1.5f * float(points - 3 * (c + 1));
+    }
+    return value;
+}
+
+Category best_category_value(const SolverState& s, int hand, float& value) {
+    const uint16_t legal = scorable_categories(s.filled, hand);
+    Category best = NUM_CATEGORIES;
+    for (int c = 0; c < NUM_CATEGORIES; ++c) {
+        if (!((legal >> c) & 1)) continue;
+        const float v = category_value(s, hand, Category(c));
+        if (best == NUM_CATEGORIES || v > value) { value = v; best = Category(c); }
+    }
+    return best;
+}
+
+// Keep reached by each hold of each hand.
+struct HandHolds {
+    uint16_t keep[NUM_HANDS][1 << NUM_DICE];
+    HandHolds() {
+        for (int h = 0; h < NUM_HANDS; ++h)
+            for (int mask = 0; mask < (1 << NUM_DICE); ++mask)
+                keep[h][mask] = uint16_t(keep_index(HAND_TABLES.dice[h], uint8_t(mask)));
+    }
+};
+
+// Lookahead: hand[r][h] is the value of hand h with r rolls left when every
+// hold from there on is the best one (through the reroll tables) and the turn
+// ends on the heuristic above. Each level takes one pass over the tables, and
+// the levels of a state are kept per thread for the rest of its turn. The
+// deadline is checked between levels: out of time, a hold is chosen on the
+// deepest level done, as if fewer rolls were left.
+class LookaheadStrategy : public Strategy {
+public:
+    const char* name() const override { return "lookahead"; }
+    uint8_t choose_hold(const GameState& g) const override {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(AI_MOVE_BUDGET_US);
+        static const HandHolds holds;
+        Levels& v = levels(solver_state(g));
+        while (v.done < g.rolls - 1 && std::chrono::steady_clock::now() < deadline) {
+            const float* prev = v.hand[v.done];
+            float keep[NUM_KEEPS];
+            for (int k = 0; k < NUM_KEEPS; ++k) keep[k] = keep_ev(k, prev);
+            float* next = v.hand[v.done + 1];
+            for (int h = 0; h < NUM_HANDS; ++h) {
+                float best = prev[h];
+                for (int mask = 0; mask < (1 << NUM_DICE) - 1; ++mask) best = std::max(best, keep[holds.keep[h][mask]]);
+                next[h] = best;
+            }
+            v.done++;
+        }
+
+        // ties favour holding more
+        const float* hand = v.hand[std::min(v.done, g.rolls - 1)];
+        uint8_t best = (1 << NUM_DICE) - 1;
+        float best_value = hand[g.hand];
+        for (int mask = (1 << NUM_DICE) - 2; mask >= 0; --mask) {
+            const float value = hold_ev(g.dice, uint8_t(mask), hand);
+            if (value > best_value) { best_value = value; best = uint8_t(mask); }
+        }
+        return best;
+    }
+    Category choose_category(const GameState& g) const override {
+        float value;
+        return best_category_value(solver_state(g), g.hand, value);
+    }
+
+private:
+    struct Levels {
+        SolverState state;
+        bool valid = false;
+        int done = 0;                             // hand[0..done] are filled in
+        float hand[ROLLS_PER_TURN - 1][NUM_HANDS];
+    };
+    static Levels& levels(const SolverState& s) {
+        static thread_local Levels v;
+        if (!v.valid || v.state.filled != s.filled || v.state.up != s.up || v.state.yahtzee50 != s.yahtzee50) {
+            v.state = s;
+            v.valid = true;
+            v.done = 0;
+            for (int h = 0; h < NUM_HANDS; ++h) best_category_value(s, h, v.hand[0][h]);
+        }
+        return v;
+    }
+};
+
+// One game, with roll_dice(g) rerolling the unheld dice.
+template <class RollDice>
+GameState play(const Strategy& s, RollDice roll_dice) {
+    GameState g;
+    while (!game_over(g)) {
+        roll_dice(g);
+        while (g.rolls > 0) {
+            const uint8_t hold = s.choose_hold(g);
+            if (hold == (1 << NUM_DICE) - 1) break;
+            g.held = hold;
+            roll_dice(g);
+        }
+        score_into(g, s.choose_category(g));
+    }
+    return g;
+}
+
+} // namespace
+
+std::unique_ptr<Strategy> make_strategy(const char* name) {
+    if (std::strcmp(name, "greedy") == 0) return std::unique_ptr<Strategy>(new GreedyStrategy);
+    if (std::strcmp(name, "upper") == 0) return std::unique_ptr<Strategy>(new UpperBonusStrategy);
+    if (std::strcmp(name, "lookahead") == 0) return std::unique_ptr<Strategy>(new LookaheadStrategy);
+    if (std::strcmp(name, "optimal") == 0 && solver_loaded()) return std::unique_ptr<Strategy>(new OptimalStrategy);
+    return nullptr;
+}
+
+GameState play_game(const Strategy& s, DiceSource<Rng>& dice) {
+    return play(s, [&](GameState& g) { roll(g, dice); });
+}
+
+void crn_dice(uint64_t seed, uint64_t game, int turn, int roll, uint8_t out[NUM_DICE]) {
+    Rng rng = Rng::stream(seed, game * (NUM_TURNS * ROLLS_PER_TURN) + uint64_t(turn * ROLLS_PER_TURN + roll));
+    DiceSource<Rng> dice(rng);
+    dice.fill(out);
+}
+
+GameState play_crn_game(const Strategy& s, uint64_t seed, uint64_t game) {
+    int turn = 0; // set at each turn's first roll, not recounted on rerolls
+    return play(s, [&](GameState& g) {
+        if (!has_rolled(g)) {
+            g.held = 0;
+            turn = popcount(g.filled);
+        }
+        uint8_t fresh[NUM_DICE];
+        crn_dice(seed, game, turn, ROLLS_PER_TURN - g.rolls, fresh);
+        for (int i = 0; i < NUM_DICE; ++i)
+            if ((g.held >> i) & 1) fresh[i] = g.dice[i];
+        set_dice(g, fresh);
+        g.rolls--;
+    });
+}
@@ -0,0 +1,40 @@
+// CL_Yahtzee strategies
+// A strategy makes a game's two kinds of decision from a read-only state:
+// which dice to hold between rolls and which category to score.
+
+#pragma once
+
+#include "yahtzee.h"
+
+#include <memory>
+
+class Strategy {
+public:
+    virtual ~Strategy() = default;
+    virtual const char* name() const = 0;
+    // Dice to hold with rerolls left (all five: stop rolling and score).
+    virtual uint8_t choose_hold(const GameState& g) const = 0;
+    // Category to score the dice into; must be one of legal_categories(g).
+    virtual Category choose_category(const GameState& g) const = 0;
+};
+
+// Time a strategy may take for one decision. "lookahead" searches until it
+// runs out and answers with the deepest search it finished.
+const int AI_MOVE_BUDGET_US = 2000;
+
+// Built-in strategies by name: "greedy" (most common face, most points now),
+// "upper" (greedy, but chasing the upper bonus), "lookahead" (searches the
+// rest of the turn against a points-over-par heuristic) and "optimal" (needs
+// the solver table). Returns null for an unknown name or a missing table.
+std::unique_ptr<Strategy> make_strategy(const char* name);
+
+// Plays one complete game with s, rolling with dice.
+GameState play_game(const Strategy& s, DiceSource<Rng>& dice);
+
+// Common random numbers: die `slot` on roll `roll` (0..2) of turn `turn` of
+// game `game` is the same whatever was held before, so strategies played on
+// the same seed see the same dice wherever their choices line up.
+void crn_dice(uint64_t seed, uint64_t game, int turn, int roll, uint8_t out[NUM_DICE]);
+
+// Plays game `game` of seed with s on common random numbers.
+GameState play_crn_game(const Strategy& s, uint64_t seed, uint64_t game);
@@ -0,0 +1,33 @@
+// CL_Yahtzee terminal backend
+// One interface over the Win32 console (terminal_win32.cpp) and POSIX
+// terminals driven through termios and ANSI sequences (terminal_posix.cpp).
+
+#pragma once
+
+#include "screen.h"
+
+#include <cstddef>
+
+// Prepares the terminal for the game: VT sequences on Windows, raw unechoed
+// keyboard input on POSIX (restored at exit). Returns false if VT sequences
+// are unavailable and the legacy console calls below must be used instead.
+bool enable_vt();
+bool vt_enabled();
+
+void clr_screen();
+void move_to(short r, short c);
+void set_color(Color c);
+inline void reset_color() { set_color(NORMAL); }
+
+// Writes raw bytes straight to the terminal.
+void write_output(const char* data, size_t size);
+
+// Blocks for one keypress and returns it without echo, like _getch(). Escape
+// is 27 and Ctrl-C is 3; other multi-byte keys (arrows etc.) come back as 0.
+int read_key();
+
+// Waits up to timeout_ms for a keypress without reading it. True if one is ready.
+bool key_ready(int timeout_ms);
+
+// Visible window size in character cells.
+bool terminal_size(int& rows, int& cols);
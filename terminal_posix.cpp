@@ -0,0 +1,127 @@
+// CL_Yahtzee terminal backend: POSIX termios + ANSI sequences
+
+#include "terminal.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+termios saved_mode;
+bool raw_mode = false;
+int pending = -1; // a key read along with a lone Escape, returned next
+
+// The next input byte, if one arrives within timeout_ms.
+bool read_byte(unsigned char& b, int timeout_ms) {
+    pollfd in{ STDIN_FILENO, POLLIN, 0 };
+    return poll(&in, 1, timeout_ms) > 0 && read(STDIN_FILENO, &b, 1) == 1;
+}
+
+void write_all(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(STDOUT_FILENO, data, size);
+        if (n <= 0) return;
+        data += n;
+        size -= size_t(n);
+    }
+}
+
+void restore_terminal() {
+    if (!raw_mode) return;
+    write_all("\033[0m", 4);
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved_mode);
+    raw_mode = false;
+}
+
+void restore_and_exit(int sig) {
+    restore_terminal();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+} // namespace
+
+bool enable_vt() {
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &saved_mode) != 0) return true; // piped input
+    termios raw = saved_mode;
+    // keys arrive one at a time, unechoed, with Ctrl-C delivered as key 3 like _getch()
+    raw.c_lflag &= ~tcflag_t(ICANON | ECHO | ISIG | IEXTEN);
+    raw.c_iflag &= ~tcflag_t(IXON | ICRNL);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) != 0) return true;
+    raw_mode = true;
+    atexit(restore_terminal);
+    signal(SIGTERM, restore_and_exit);
+    signal(SIGHUP, restore_and_exit);
+    return true;
+}
+
+bool vt_enabled() { return true; }
+
+void clr_screen() {
+    write_all("\033[2J\033[H", 7);
+}
+
+void move_to(short r, short c) {
+    char buf[24];
+    int n = snprintf(buf, sizeof(buf), "\033[%d;%dH", r, c);
+    write_all(buf, size_t(n));
+}
+
+void set_color(Color c) {
+    if (c == YELLOW) write_all("\033[33m", 5);
+    else if (c == RED) write_all("\033[31m", 5);
+    else write_all("\033[0m", 4);
+}
+
+void write_output(const char* data, size_t size) {
+    write_all(data, size);
+}
+
+int read_key() {
+    if (pending >= 0) {
+        const int key = pending;
+        pending = -1;
+        return key;
+    }
+    unsigned char key;
+    if (read(STDIN_FILENO, &key, 1) != 1) return 27; // end of input quits like Escape
+    if (key != 27) return key;
+    // a lone Escape, or the start of an escape sequence (arrow keys etc.)?
+    unsigned char b;
+    if (!read_byte(b, 30)) return 27;
+    if (b != '[' && b != 'O') {
+        pending = b;
+        return 27;
+    }
+    // CSI/SS3: parameter and intermediate bytes up to the final one. Only the
+    // sequence is dropped; a byte that can't be part of it is kept for next time.
+    while (read_byte(b, 30)) {
+        if (b >= 0x40 && b <= 0x7e) return 0;
+        if (b < 0x20 || b > 0x3f) {
+            pending = b;
+            return 0;
+        }
+    }
+    return 0;
+}
+
+bool key_ready(int timeout_ms) {
+    if (pending >= 0) return true;
+    pollfd in{ STDIN_FILENO, POLLIN, 0 };
+    return poll(&in, 1, timeout_ms) > 0;
+}
+
+bool terminal_size(int& rows, int& cols) {
+    winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != 0 || ws.ws_col == 0) return false;
+    rows = ws.ws_row;
+    cols = ws.ws_col;
+    return true;
+}
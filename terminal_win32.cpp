@@ -0,0 +1,117 @@
+// CL_Yahtzee terminal backend: Win32 console
+
+#include "terminal.h"
+
+#include <conio.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <windows.h>
+#include <mmsystem.h>
+
+// --- Console VT (ANSI) enable + fallback ---
+static bool VT_ENABLED = false;
+static HANDLE HOUT = GetStdHandle(STD_OUTPUT_HANDLE);
+static HANDLE HIN = GetStdHandle(STD_INPUT_HANDLE);
+static WORD DEFAULT_ATTRS = 0;
+
+bool enable_vt()
+{
+    DWORD mode = 0;
+    if (!GetConsoleMode(HOUT, &mode)) return false;
+    // Save default attributes
+    CONSOLE_SCREEN_BUFFER_INFO info{};
+    if (GetConsoleScreenBufferInfo(HOUT, &info)) DEFAULT_ATTRS = info.wAttributes;
+    // Try to enable VT
+    DWORD newMode = mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+    if (!SetConsoleMode(HOUT, newMode)) return false;
+    VT_ENABLED = true;
+    return true;
+}
+
+bool vt_enabled() { return VT_ENABLED; }
+
+void clr_screen()
+{
+    if (VT_ENABLED) {
+        std::cout << "\033[2J\033[H" << std::flush;
+    } else {
+        system("cls"); // legacy fallback
+    }
+}
+
+void move_to(short r, short c) {
+    COORD pos{ static_cast<SHORT>(c - 1), static_cast<SHORT>(r - 1) };
+    SetConsoleCursorPosition(GetStdHandle(STD_OUTPUT_HANDLE), pos);
+}
+
+void set_color(Color c)
+{
+    if (VT_ENABLED) {
+        if (c == YELLOW) std::cout << "\033[33m";
+        else if (c == RED) std::cout << "\033[31m";
+        else std::cout << "\033[0m";
+    } else {
+        WORD attr = DEFAULT_ATTRS;
+        if (c == YELLOW) attr = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY;
+        if (c == RED)    attr = FOREGROUND_RED | FOREGROUND_INTENSITY;
+        SetConsoleTextAttribute(HOUT, attr);
+    }
+}
+
+void write_output(const char* data, size_t size) {
+    std::cout.flush(); // keep ordering with anything set_color queued
+    fwrite(data, 1, size, stdout);
+    fflush(stdout);
+}
+
+int read_key() {
+    int key = _getch();
+    if (key == 0 || key == 224) { _getch(); return 0; } // arrows and function keys
+    return key;
+}
+
+// milliseconds on the performance counter (GetTickCount only moves every 15.6 ms)
+static double now_ms() {
+    static const double ticks_per_ms = [] {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        return double(f.QuadPart) / 1000.0;
+    }();
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return double(t.QuadPart) / ticks_per_ms;
+}
+
+bool key_ready(int timeout_ms) {
+    // waits end on a system timer tick, 15.6 ms apart by default (longer than a
+    // frame): ask for 1 ms ticks, once, for the rest of the run
+    static const bool fine_ticks = timeBeginPeriod(1) == TIMERR_NOERROR;
+    (void)fine_ticks;
+    const double deadline = now_ms() + timeout_ms;
+    while (true) {
+        // console input also carries mouse, focus and key-up events: only what
+        // _getch would return counts, and the rest are taken off the queue so
+        // the handle doesn't stay signalled
+        DWORD pending = 0;
+        GetNumberOfConsoleInputEvents(HIN, &pending);
+        if (_kbhit()) return true;
+        while (pending > 0) {
+            INPUT_RECORD events[16];
+            DWORD read = 0;
+            if (!ReadConsoleInputA(HIN, events, pending < 16 ? pending : 16, &read) || read == 0) break;
+            pending -= read;
+        }
+        const double left = deadline - now_ms();
+        if (left <= 0) return false;
+        WaitForSingleObject(HIN, DWORD(left) + 1);
+    }
+}
+
+bool terminal_size(int& rows, int& cols) {
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    if (!GetConsoleScreenBufferInfo(HOUT, &csbi)) return false;
+    cols = csbi.srWindow.Right - csbi.srWindow.Left + 1;
+    rows = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+    return true;
+}
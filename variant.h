@@ -0,0 +1,90 @@
+// CL_Yahtzee rule variants
+// A headless game for any variant in rules.h, with its state sized by the
+// variant and scoring through its compile-time HandTable. The classic game
+// (with the Yahtzee bonus and Jokers) stays GameState in yahtzee.h.
+
+#pragma once
+
+#include "yahtzee.h"
+
+template <class V>
+struct VariantGame {
+    static constexpr uint32_t ALL = (1u << V::NUM_CATEGORIES) - 1;
+    uint8_t score[V::NUM_CATEGORIES] = {};
+    uint32_t filled = 0;                // bit c set once category c is final
+    uint8_t dice[V::DICE] = {};
+    uint8_t held = 0;
+    uint8_t rolls = ROLLS_PER_TURN;
+};
+
+template <class V>
+inline bool game_over(const VariantGame<V>& g) { return g.filled == VariantGame<V>::ALL; }
+
+template <class V>
+inline int grand_total(const VariantGame<V>& g) {
+    int upper = 0, total = 0;
+    for (int c = 0; c < V::NUM_CATEGORIES; ++c) {
+        if (!((g.filled >> c) & 1)) continue;
+        total += g.score[c];
+        if (c < V::UPPER_CATEGORIES) upper += g.score[c];
+    }
+    return total + (upper >= V::UPPER_BONUS_THRESHOLD ? V::UPPER_BONUS : 0);
+}
+
+template <class V, class URBG>
+inline bool roll(VariantGame<V>& g, DiceSource<URBG>& dice) {
+    if (g.rolls == 0 || game_over(g)) return false;
+    if (g.rolls == ROLLS_PER_TURN) g.held = 0;
+    dice.fill(g.dice, V::DICE, g.held);
+    g.rolls--;
+    return true;
+}
+
+template <class V>
+inline bool score_into(VariantGame<V>& g, int c) {
+    if (c < 0 || c >= V::NUM_CATEGORIES || ((g.filled >> c) & 1) || g.rolls == ROLLS_PER_TURN) return false;
+    g.score[c] = HAND_TABLE<V>.score[variant_hand_index<V>(g.dice)][c];
+    g.filled |= 1u << c;
+    g.held = 0;
+    g.rolls = ROLLS_PER_TURN;
+    return true;
+}
+
+// A game played greedily: keep the most common face (highest on ties), then
+// take the most points, giving up the open category worth least at best when
+// nothing scores. Returns the final score.
+template <class V>
+int play_greedy_variant(DiceSource<Rng>& dice) {
+    const HandTable<V>& table = HAND_TABLE<V>;
+    VariantGame<V> g;
+    while (!game_over(g)) {
+        roll(g, dice);
+        while (g.rolls > 0) {
+            int counts[V::FACES + 1] = {};
+            for (int i = 0; i < V::DICE; ++i) counts[g.dice[i]]++;
+            int face = V::FACES;
+            for (int v = V::FACES - 1; v >= 1; --v) if (counts[v] > counts[face]) face = v;
+            if (counts[face] == V::DICE) break;
+            g.held = 0;
+            for (int i = 0; i < V::DICE; ++i) if (g.dice[i] == face) g.held |= uint8_t(1u << i);
+            roll(g, dice);
+        }
+        const uint8_t* scores = table.score[variant_hand_index<V>(g.dice)];
+        int best = -1;
+        for (int c = 0; c < V::NUM_CATEGORIES; ++c) {
+            if ((g.filled >> c) & 1) continue;
+            if (best < 0 || scores[c] > scores[best] ||
+                (scores[c] == scores[best] && table.max_score[c] < table.max_score[best])) best = c;
+        }
+        score_into(g, best);
+    }
+    return grand_total(g);
+}
+
+// Most a variant's scorecard can add up to.
+template <class V>
+constexpr int variant_max_score() {
+    int total = V::UPPER_BONUS;
+    for (int c = 0; c < V::NUM_CATEGORIES; ++c) total += HAND_TABLE<V>.max_score[c];
+    return total;
+}
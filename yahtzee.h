@@ -0,0 +1,376 @@
+// CL_Yahtzee game-state engine
+// Pure rules with no console dependency, so games can be played headless.
+
+#pragma once
+
+#include "rules.h"
+
+#include <cstdint>
+#include <limits>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+enum Category : uint8_t {
+    ONES, TWOS, THREES, FOURS, FIVES, SIXES,                  // upper section
+    THREE_OF_A_KIND, FOUR_OF_A_KIND, FULL_HOUSE,              // lower section
+    SML_STRAIGHT, LRG_STRAIGHT, YAHTZEE, CHANCE,
+    NUM_CATEGORIES
+};
+
+const int NUM_DICE = 5;
+const int NUM_TURNS = NUM_CATEGORIES;
+const int ROLLS_PER_TURN = 3;
+const int UPPER_BONUS_THRESHOLD = 63;
+const int UPPER_BONUS = 35;
+const int YAHTZEE_BONUS = 100;
+const int MAX_SCORE = 1575;     // a Yahtzee every turn: 375 plus twelve Yahtzee bonuses
+
+const uint16_t UPPER_MASK = (1u << THREE_OF_A_KIND) - 1;
+const uint16_t ALL_CATEGORIES = (1u << NUM_CATEGORIES) - 1;
+
+// Set bits in x (category masks, hold masks).
+inline int popcount(uint32_t x) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return int(__popcnt(x));
+#elif defined(_MSC_VER)
+    x -= (x >> 1) & 0x55555555u;
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    return int((((x + (x >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24);
+#else
+    return __builtin_popcount(x);
+#endif
+}
+
+// Index of the lowest set bit of x, which must not be 0.
+inline int lowest_bit(uint64_t x) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return int(i);
+#elif defined(_MSC_VER)
+    unsigned long i;
+    if (_BitScanForward(&i, uint32_t(x))) return int(i);
+    _BitScanForward(&i, uint32_t(x >> 32));
+    return int(i) + 32;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+// Complete state of one solitaire game. Plain value type: copy it freely.
+// Change the dice only through roll or set_dice, which keep hand in step.
+struct GameState {
+    uint8_t score[NUM_CATEGORIES] = {}; // points in each slot (only meaningful once filled)
+    uint16_t filled = 0;                // bit c set once category c is final
+    uint8_t dice[NUM_DICE] = {};        // 0 until the first roll of the turn
+    uint8_t held = 0;                   // bit i set if die i is held
+    uint8_t rolls = ROLLS_PER_TURN;     // rolls left this turn
+    uint8_t yahtzee_bonuses = 0;        // extra Yahtzees rolled with 50 in the Yahtzee box
+    uint8_t hand = 0;                   // hand_index(dice) once rolled, so scoring skips the lookup
+};
+
+// Fast 64-bit generator for headless play (SplitMix64). Satisfies
+// UniformRandomBitGenerator, so std::mt19937 and friends are interchangeable.
+struct Rng {
+    using result_type = uint64_t;
+    uint64_t state;
+
+    explicit Rng(uint64_t seed = 0) : state(seed) {}
+    // Independent generator number `stream` of a seed (counter-based: no
+    // generator has to be advanced to reach it).
+    static Rng stream(uint64_t seed, uint64_t stream) {
+        Rng mix(seed ^ (stream * 0xd1342543de82ef95ull));
+        return Rng(mix());
+    }
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<uint64_t>::max(); }
+    result_type operator()() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+};
+
+// Exactly uniform d6 values, many per generator call. An output is accepted
+// if it's below the largest multiple of 6^DIGITS the generator can produce
+// (others are drawn again) and then read as DIGITS base-6 digits, one die
+// each. A 64-bit generator gives 24 dice per accepted call (3 in 4 are).
+template <class URBG>
+class DiceSource {
+public:
+    explicit DiceSource(URBG& g) : g(g) {}
+
+    int next() {
+        if (left == 0) refill();
+        const int die = int(digits % 6) + 1;
+        digits /= 6;
+        left--;
+        return die;
+    }
+
+    // Rolls every die of hand (count dice, five by default) not held in the bitmask.
+    void fill(uint8_t* hand, int count, uint8_t held) {
+        if (count == NUM_DICE && held == 0) { fill_hand(hand); return; }
+        for (int i = 0; i < count; ++i)
+            if (!((held >> i) & 1)) hand[i] = uint8_t(next());
+    }
+
+    // Rolls all five dice of hand (the same dice as fill) and returns the roll
+    // as a number below 6^5 whose base-6 digit i is die i less one.
+    int fill_hand(uint8_t hand[NUM_DICE]) {
+        uint32_t c;
+        if (left >= NUM_DICE) {
+            c = uint32_t(digits % HAND_POW);
+            digits /= HAND_POW;
+            left -= NUM_DICE;
+        } else {
+            // the last few digits, then the rest from the next generator output
+            static constexpr uint32_t SCALE[NUM_DICE] = { 1, 6, 36, 216, 1296 };
+            const uint32_t low = uint32_t(digits), scale = SCALE[left];
+            const int need = NUM_DICE - left;
+            refill();
+            uint32_t high;
+            switch (need) {
+            case 1: high = uint32_t(digits % 6); digits /= 6; break;
+            case 2: high = uint32_t(digits % 36); digits /= 36; break;
+            case 3: high = uint32_t(digits % 216); digits /= 216; break;
+            case 4: high = uint32_t(digits % 1296); digits /= 1296; break;
+            default: high = uint32_t(digits % HAND_POW); digits /= HAND_POW; break;
+            }
+            left -= need;
+            c = low + scale * high;
+        }
+        // one division or two took all five digits; each die is split off on its own
+        hand[0] = uint8_t(c % 6 + 1);
+        hand[1] = uint8_t(c / 6 % 6 + 1);
+        hand[2] = uint8_t(c / 36 % 6 + 1);
+        hand[3] = uint8_t(c / 216 % 6 + 1);
+        hand[4] = uint8_t(c / 1296 + 1);
+        return int(c);
+    }
+    void fill(uint8_t hand[NUM_DICE], uint8_t held = 0) { fill(hand, NUM_DICE, held); }
+
+    // The dice left over from the last generator call. Saved along with the
+    // generator, they let a game picked up later roll exactly the same dice.
+    uint64_t buffered_digits() const { return digits; }
+    int buffered() const { return left; }
+    void restore_buffer(uint64_t saved_digits, int saved_left) { digits = saved_digits; left = saved_left; }
+
+private:
+    static constexpr uint64_t RANGE = uint64_t(URBG::max() - URBG::min()); // outputs - 1
+    static constexpr int count_digits() {
+        int k = 0;
+        for (uint64_t p = 1; p <= RANGE / 6 + (RANGE % 6 == 5); p *= 6) ++k;
+        return k;
+    }
+    static constexpr uint64_t power_of_6(int k) { return k == 0 ? 1 : 6 * power_of_6(k - 1); }
+    static constexpr int DIGITS = count_digits();
+    static constexpr uint64_t POW = power_of_6(DIGITS);
+    static constexpr uint64_t HAND_POW = power_of_6(NUM_DICE);
+    static_assert(HAND_POW == 7776, "fill splits a hand's digits with these constants");
+    // last accepted output: outputs / POW whole blocks of POW values
+    static constexpr uint64_t LAST = (RANGE / POW + (RANGE % POW == POW - 1)) * POW - 1;
+    static_assert(DIGITS >= 5, "need at least a hand's worth of dice per generator call");
+
+    void refill() {
+        uint64_t x;
+        do x = uint64_t(g() - URBG::min()); while (x > LAST);
+        digits = x % POW;
+        left = DIGITS;
+    }
+
+    URBG& g;
+    uint64_t digits = 0;
+    int left = 0;
+};
+
+// One die straight from a generator (the rest of the call's dice are dropped).
+template <class URBG>
+inline int roll_die(URBG& g) {
+    return DiceSource<URBG>(g).next();
+}
+
+// --- scoring ---
+
+inline bool is_filled(const GameState& g, Category c) { return (g.filled >> c) & 1; }
+inline bool has_rolled(const GameState& g) { return g.rolls < ROLLS_PER_TURN; }
+inline bool game_over(const GameState& g) { return g.filled == ALL_CATEGORIES; }
+
+// Every scoring path goes through a table built at compile time from the
+// classic rules (rules.h): the 252 distinct (sorted) hands of five dice, each
+// with its 13 category scores. A hand's index is found in O(1) by summing a
+// per-face weight into a key that only depends on how many dice show each
+// face, so order is irrelevant.
+using HandTables = HandTable<ClassicYahtzee>;
+static_assert(HandTables::DICE == NUM_DICE && HandTables::CATEGORIES == NUM_CATEGORIES &&
+              ClassicYahtzee::UPPER_BONUS_THRESHOLD == UPPER_BONUS_THRESHOLD && ClassicYahtzee::UPPER_BONUS == UPPER_BONUS,
+              "the Category enum and the constants above must match the classic rules");
+const int NUM_HANDS = HandTables::HANDS;
+const int NUM_HAND_KEYS = HandTables::KEYS;
+
+inline constexpr const HandTables& HAND_TABLES = HAND_TABLE<ClassicYahtzee>;
+inline constexpr const int (&HAND_KEY_WEIGHT)[7] = HAND_TABLES.key_weight; // 6^(face - 1)
+
+// Index (0..251) of the hand shown by five dice, in any order.
+inline int hand_index(const uint8_t dice[NUM_DICE]) {
+    const int key = HAND_KEY_WEIGHT[dice[0]] + HAND_KEY_WEIGHT[dice[1]] + HAND_KEY_WEIGHT[dice[2]] +
+                    HAND_KEY_WEIGHT[dice[3]] + HAND_KEY_WEIGHT[dice[4]];
+    return HAND_TABLES.index_of_key[key];
+}
+
+// Hand index of each of the 6^5 rolls by its number from DiceSource::fill_hand,
+// so a fresh roll's hand is one byte from a table that stays in L1.
+struct RollHands {
+    uint8_t hand[7776];
+};
+constexpr RollHands make_roll_hands() {
+    RollHands t{};
+    for (int c = 0; c < 7776; ++c) {
+        int key = 0;
+        for (int i = 0, digits = c; i < NUM_DICE; ++i, digits /= 6) key += HAND_KEY_WEIGHT[digits % 6 + 1];
+        t.hand[c] = HAND_TABLES.index_of_key[key];
+    }
+    return t;
+}
+inline constexpr RollHands ROLL_HANDS = make_roll_hands();
+
+// Sets g's dice (and with them its hand).
+inline void set_dice(GameState& g, const uint8_t dice[NUM_DICE]) {
+    for (int i = 0; i < NUM_DICE; ++i) g.dice[i] = dice[i];
+    g.hand = uint8_t(hand_index(dice));
+}
+
+// All 13 category scores of a hand.
+inline const uint8_t* hand_scores(int hand) { return HAND_TABLES.score[hand]; }
+
+// Points the five dice would score in category c.
+inline int category_score(const uint8_t dice[NUM_DICE], Category c) {
+    return HAND_TABLES.score[hand_index(dice)][c];
+}
+
+// --- Yahtzee bonus and Joker rules ---
+// A Yahtzee rolled once the Yahtzee box is filled is a Joker. It earns a 100
+// point bonus if that box holds 50, and must go in the upper box of its face
+// if open, else in any open lower box (Full House and the straights scoring
+// in full), else in any open upper box for 0.
+
+inline bool is_yahtzee_hand(int hand) { return hand_scores(hand)[YAHTZEE] != 0; }
+inline bool is_joker(uint16_t filled, int hand) { return ((filled >> YAHTZEE) & 1) && is_yahtzee_hand(hand); }
+
+// Categories a Joker may be scored in with the categories in filled taken.
+inline uint16_t joker_categories(uint16_t filled, int hand) {
+    const uint16_t open = uint16_t(~filled & ALL_CATEGORIES);
+    const uint16_t own_box = uint16_t(1u << (HAND_TABLES.dice[hand][0] - 1));
+    if (open & own_box) return own_box;
+    return (open & ~UPPER_MASK) ? uint16_t(open & ~UPPER_MASK) : open;
+}
+
+// Points a Joker scores in c: Full House and the straights in full.
+inline int joker_points(int hand, Category c) {
+    if (c == FULL_HOUSE) return 25;
+    if (c == SML_STRAIGHT) return 30;
+    if (c == LRG_STRAIGHT) return 40;
+    return hand_scores(hand)[c];
+}
+
+// Categories a hand may be scored in with the categories in filled taken.
+inline uint16_t scorable_categories(uint16_t filled, int hand) {
+    return is_joker(filled, hand) ? joker_categories(filled, hand) : uint16_t(~filled & ALL_CATEGORIES);
+}
+
+// Points a hand scores in c, Joker values included (the Yahtzee bonus is not).
+inline int hand_points(uint16_t filled, int hand, Category c) {
+    return is_joker(filled, hand) ? joker_points(hand, c) : hand_scores(hand)[c];
+}
+
+// Does the Yahtzee box hold 50 (so every further Yahtzee earns the bonus)?
+inline bool yahtzee_scored_50(const GameState& g) {
+    return is_filled(g, YAHTZEE) && g.score[YAHTZEE] == 50;
+}
+
+// Points the current dice would score in c (0 before the first roll).
+inline int potential_score(const GameState& g, Category c) {
+    return has_rolled(g) ? hand_points(g.filled, g.hand, c) : 0;
+}
+
+inline int upper_subtotal(const GameState& g) {
+    int total = 0;
+    for (int c = ONES; c <= SIXES; ++c) if (is_filled(g, Category(c))) total += g.score[c];
+    return total;
+}
+inline int upper_bonus(const GameState& g) {
+    return upper_subtotal(g) >= UPPER_BONUS_THRESHOLD ? UPPER_BONUS : 0;
+}
+inline int lower_total(const GameState& g) {
+    int total = 0;
+    for (int c = THREE_OF_A_KIND; c <= CHANCE; ++c) if (is_filled(g, Category(c))) total += g.score[c];
+    return total;
+}
+inline int yahtzee_bonus(const GameState& g) {
+    return g.yahtzee_bonuses * YAHTZEE_BONUS;
+}
+inline int grand_total(const GameState& g) {
+    return upper_subtotal(g) + upper_bonus(g) + lower_total(g) + yahtzee_bonus(g);
+}
+
+// --- rules ---
+
+// Clears dice, holds and rolls for a new turn.
+inline void start_turn(GameState& g) {
+    for (int i = 0; i < NUM_DICE; ++i) g.dice[i] = 0;
+    g.held = 0;
+    g.rolls = ROLLS_PER_TURN;
+}
+
+// Rerolls every unheld die. Returns false if no rolls are left.
+template <class URBG>
+inline bool roll(GameState& g, DiceSource<URBG>& dice) {
+    if (g.rolls == 0 || game_over(g)) return false;
+    if (!has_rolled(g)) g.held = 0; // the first roll always throws all five
+    if (g.held) {
+        // die by die: going through fill would inline the fresh roll below twice
+        for (int i = 0; i < NUM_DICE; ++i)
+            if (!((g.held >> i) & 1)) g.dice[i] = uint8_t(dice.next());
+        g.hand = uint8_t(hand_index(g.dice));
+    } else {
+        g.hand = ROLL_HANDS.hand[dice.fill_hand(g.dice)];
+    }
+    g.rolls--;
+    return true;
+}
+
+// Same, straight from a generator. Keep a DiceSource for the whole game instead
+// when rolling a lot: this one draws a fresh generator output every roll.
+template <class URBG>
+inline bool roll(GameState& g, URBG& rng) {
+    DiceSource<URBG> dice(rng);
+    return roll(g, dice);
+}
+
+// Holds or releases die i (0-based). Only valid once the dice have been rolled.
+inline bool toggle_hold(GameState& g, int die) {
+    if (die < 0 || die >= NUM_DICE || !has_rolled(g)) return false;
+    g.held ^= uint8_t(1u << die);
+    return true;
+}
+
+// Bitmask of categories the current dice may be scored into (Joker rules included).
+inline uint16_t legal_categories(const GameState& g) {
+    return has_rolled(g) ? scorable_categories(g.filled, g.hand) : 0;
+}
+
+// Scores the current dice into c, with any Yahtzee bonus, and starts the next turn.
+// Returns false (and leaves g untouched) if c is not legal right now.
+inline bool score_into(GameState& g, Category c) {
+    if (c >= NUM_CATEGORIES || !((legal_categories(g) >> c) & 1)) return false;
+    // Joker rules only come in for a second Yahtzee
+    const int hand = g.hand;
+    const bool joker = is_joker(g.filled, hand);
+    g.score[c] = uint8_t(joker ? joker_points(hand, c) : hand_scores(hand)[c]);
+    if (joker && g.score[YAHTZEE] == 50) g.yahtzee_bonuses++;
+    g.filled |= uint16_t(1u << c);
+    start_turn(g);
+    return true;
+}